@@ -2,174 +2,150 @@
 #include <Wire.h>
 
 #include "board_config.h"
+#include "dew_curve.h"
+#include "dewpoint.h"
 #include "eeprom_cfg.h"
+#include "eeprom_names.h"
+#include "eeprom_wear.h"
+#include "eventlog.h"
+#include "history.h"
+#include "i2c_bus.h"
 #include "ports.h"
 #include "probes.h"
 #include "protocol.h"
+#include "scheduler.h"
 #include "serial_framing.h"
 #include "serial_out.h"
-#include <math.h>
+#include "timing.h"
+#include "trend.h"
 #include <string.h>
 
-enum FsmState { STATE_IDLE, STATE_READ, STATE_SWAP };
-
 static CommandQueue g_queue;
 static Ports g_ports;
-static FsmState g_state = STATE_IDLE;
-static unsigned long g_last_refresh = 0;
 static uint8_t g_port_index = 0;
-static uint8_t g_chip = 0;
-static bool g_dsel = true;
-static unsigned long g_last_sensor_ms = 0;
-static Probes g_probes;
 Config g_config;
-static unsigned long g_last_dew_ms = 0;
-static unsigned long g_last_dewpoint_ms = 0;
-#ifdef DEBUG
-static unsigned long g_last_dew_log_ms = 0;
-#endif
+History g_history;
+DewCurveSettings g_dew_curve_settings;
+DewCurve g_dew_curves[PWM_PORT_COUNT];
+Trend g_trend;
+Probes g_probes;
+static bool g_overvoltage_tripped = false;
 
 char g_board_signature[BOARD_SIGNATURE_MAX_LEN];
 
-static void adc_swap_ports(uint8_t port_max) {
-  // Increment port index and wrap.
+// Route the current-sense mux to a port's channel.
+static void select_sense_channel(uint8_t port) {
+  uint8_t ch = board_port_mux(port);
+  digitalWrite(DSEL, (ch & 0x01) ? HIGH : LOW);
+  digitalWrite(MUX0, bitRead(ch, 1));
+  digitalWrite(MUX1, bitRead(ch, 2));
+  digitalWrite(MUX2, bitRead(ch, 3));
+}
+
+static void adc_swap_ports() {
   g_port_index++;
-  if (g_port_index >= port_max)
+  if (g_port_index >= PORT_COUNT)
     g_port_index = 0;
-
-  // Toggle DSEL each swap.
-  g_dsel = !g_dsel;
-  digitalWrite(DSEL, g_dsel ? HIGH : LOW);
-
-  // Advance mux chip on even port indices.
-  if ((g_port_index % 2) == 0)
-    g_chip++;
-  // Board-specific mapping: skip extra slot before always-on ports.
-  if (g_port_index == 13)
-    g_chip++;
-  if (g_chip > port_max / 2)
-    g_chip = 0;
-
-  digitalWrite(MUX0, bitRead(g_chip, 0));
-  digitalWrite(MUX1, bitRead(g_chip, 1));
-  digitalWrite(MUX2, bitRead(g_chip, 2));
+  select_sense_channel(g_port_index);
 }
 
-static int32_t dew_margin_centi(int32_t t_centi, int32_t rh_centi) {
-  float t = t_centi / 100.0f;
-  float rh = rh_centi / 100.0f;
-  if (rh < 1.0f)
-    rh = 1.0f;
-  if (rh > 100.0f)
-    rh = 100.0f;
-  const float a = 17.62f;
-  const float b = 243.12f;
-  float gamma = (a * t) / (b + t) + logf(rh / 100.0f);
-  float t_dew = (b * gamma) / (a - gamma);
-  float margin = t - t_dew;
-  return (int32_t)(margin * 100.0f);
-}
+static void update_ambient_port(Ports* ports, uint8_t i, int32_t margin, uint32_t dt_ms) {
+  const DewCurve* curve = &g_dew_curves[i];
+  bool was_active = ports->dew_active[i];
+  if (!was_active) {
+    if (margin < curve->m_on_centi)
+      ports->dew_active[i] = true;
+  } else {
+    if (margin > curve->m_on_centi + DEW_M_HYST_CENTI)
+      ports->dew_active[i] = false;
+  }
 
-static uint8_t smoothstep_duty(uint8_t duty_min, uint8_t duty_max, int32_t margin_centi,
-                               int32_t dew_m_on_centi) {
-  if (margin_centi >= dew_m_on_centi)
-    return 0;
-  if (margin_centi <= DEW_M_FULL_CENTI)
-    return duty_max;
-  int32_t num = dew_m_on_centi - margin_centi;
-  int32_t den = dew_m_on_centi - DEW_M_FULL_CENTI;
-  if (den <= 0)
-    return duty_min;
-  int32_t x_q12 = (num << 12) / den;
-  if (x_q12 < 0)
-    x_q12 = 0;
-  if (x_q12 > 4096)
-    x_q12 = 4096;
-  int32_t x2_q12 = (x_q12 * x_q12) >> 12;
-  int32_t term_q12 = (3 << 12) - (2 * x_q12);
-  int32_t smooth_q12 = (x2_q12 * term_q12) >> 12;
-  int32_t duty = duty_min + ((smooth_q12 * (duty_max - duty_min)) >> 12);
-  if (duty < 0)
-    duty = 0;
-  if (duty > 255)
-    duty = 255;
-  return (uint8_t)duty;
+  uint16_t target_duty = ports->dew_active[i] ? dew_curve_lookup(curve, margin) : 0;
+  uint16_t limited = target_duty;
+  if (limited != 0 && was_active) {
+    // Rate-limit while heating; jump straight to the table duty when it
+    // starts and turn off immediately.
+    limited = dew_curve_slew(curve, &ports->dew_slew_level[i], limited, dt_ms);
+  } else {
+    ports->dew_slew_level[i] = limited;
+  }
+  ports_apply_dew_duty(ports, i, limited);
 }
 
-static uint8_t slew_limit(uint8_t current, uint8_t target) {
-  uint8_t step = (uint8_t)((DEW_DUTY_SLEW_STEP_PCT * 255 + 50) / 100);
-  if (target > current) {
-    uint8_t delta = target - current;
-    if (delta > step)
-      return current + step;
-  } else if (current > target) {
-    uint8_t delta = current - target;
-    if (delta > step)
-      return current - step;
-  }
-  return target;
+// Hold the strap its on-margin above the dew point, raised by `lead` when the
+// margin is projected to shrink.
+static void update_pi_port(Ports* ports, uint8_t i, int32_t lead, uint32_t dt_ms) {
+  const DewCurve* curve = &g_dew_curves[i];
+  int32_t setpoint = ports->dewpoint_centi + curve->m_on_centi + lead;
+  uint16_t duty =
+      dew_pi_update(&ports->dew_pi[i], setpoint, ports->strap_centi[i], curve->duty_max, dt_ms);
+  ports->dew_active[i] = duty > 0;
+  ports_apply_dew_duty(ports, i, duty);
 }
 
-static uint8_t quantize_duty_pct(uint8_t duty) {
-  if (duty == 0)
-    return 0;
-  uint8_t pct = (uint8_t)((duty * 100L + 127) / 255);
-  uint8_t rounded = (uint8_t)(((pct + 2) / 5) * 5);
-  if (rounded > 100)
-    rounded = 100;
-  return (uint8_t)((rounded * 255L + 50) / 100);
+// Read sensors at the minimum interval near the closest dew threshold and
+// stretch linearly to the maximum as the margin grows.
+static void update_sample_interval(Ports* ports, int32_t margin) {
+  int32_t threshold = 0;
+  bool any_dew = false;
+  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+    if (!ports_is_dew_mode(ports->pwm_mode[i]))
+      continue;
+    if (!any_dew || g_dew_curves[i].m_on_centi > threshold)
+      threshold = g_dew_curves[i].m_on_centi;
+    any_dew = true;
+  }
+  uint16_t lo = g_config.sample_min_ms;
+  uint16_t hi = g_config.sample_max_ms;
+  int32_t d = margin - threshold;
+  if (!any_dew || d >= SAMPLE_FAR_CENTI) {
+    ports->sample_interval_ms = hi;
+  } else if (d <= SAMPLE_NEAR_CENTI) {
+    ports->sample_interval_ms = lo;
+  } else {
+    ports->sample_interval_ms =
+        (uint16_t)(lo + (int32_t)(hi - lo) * (d - SAMPLE_NEAR_CENTI) / (SAMPLE_FAR_CENTI - SAMPLE_NEAR_CENTI));
+  }
 }
 
-static void update_dew_control(Ports* ports) {
+static void update_dew_control(Ports* ports, uint32_t dt_ms) {
   if (!ports || !ports->have_temp)
     return;
-  int32_t margin = dew_margin_centi(ports->temp_centi, ports->humid_centi);
-  ports->dewpoint_centi = ports->temp_centi - margin;
-  int32_t dew_m_on_centi = g_config.dew_m_on_centi;
-  bool was_active = ports->dew_active;
-  if (!ports->dew_active) {
-    if (margin < dew_m_on_centi)
-      ports->dew_active = true;
-  } else {
-    if (margin > DEW_M_OFF_CENTI)
-      ports->dew_active = false;
+  // dewpoint_centi is updated with every sensor reading.
+  int32_t margin = ports->temp_centi - ports->dewpoint_centi;
+  // Pre-heat on the projected margin when the trend says it is falling.
+  int32_t control = margin;
+  int32_t proj_t, proj_rh;
+  if (trend_project(&g_trend, &proj_t, &proj_rh)) {
+    int32_t projected = dew_margin_centi(proj_t, proj_rh);
+    if (projected < control)
+      control = projected;
   }
-
-  uint8_t target_duty = 0;
-  if (ports->dew_active) {
-    uint8_t duty_min_pct = g_config.dew_duty_min_pct;
-    uint8_t duty_max_pct = g_config.dew_duty_max_auto_pct;
-    if (duty_min_pct > duty_max_pct) {
-      duty_min_pct = duty_max_pct;
-    }
-    uint8_t duty_min = (uint8_t)((duty_min_pct * 255) / 100);
-    uint8_t duty_max = (uint8_t)((duty_max_pct * 255) / 100);
-    uint8_t raw_target = smoothstep_duty(duty_min, duty_max, margin, dew_m_on_centi);
-    if (raw_target == 0) {
-      target_duty = 0;
-    } else if (raw_target < duty_min) {
-      // Drop to off when below minimum to avoid tiny duty cycles.
-      target_duty = 0;
-    } else {
-      target_duty = raw_target;
+  // Each dew port runs its own controller and settings.
+  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+    uint8_t mode = ports->pwm_mode[i];
+    if (mode == PWM_MODE_DEW_PI && (ports->strap_mask & (1u << i))) {
+      update_pi_port(ports, i, margin - control, dt_ms);
+    } else if (ports_is_dew_mode(mode)) {
+      // Without a strap sensor mode 3 falls back to the ambient model.
+      dew_pi_reset(&ports->dew_pi[i]);
+      update_ambient_port(ports, i, control, dt_ms);
     }
   }
-  uint8_t limited = target_duty;
-  if (limited == 0) {
-    // Turn off immediately once below minimum.
-    limited = 0;
-  } else if (!was_active && ports->dew_active) {
-    // Jump straight to minimum when heating starts.
-    limited = quantize_duty_pct(limited);
-  } else {
-    limited = slew_limit(ports->dew_duty, limited);
-    limited = quantize_duty_pct(limited);
+  update_sample_interval(ports, control);
+}
+
+// Persist manual PWM levels once their ramps have finished.
+static void save_pwm_levels(const Ports* ports) {
+  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+    if (!ports_is_dew_mode(ports->pwm_mode[i]) && !ports_ramping(ports, i))
+      g_config.pwmPorts[i] = ports->pwm_level[i];
   }
-  ports_apply_dew_duty(ports, limited);
+  eeprom_cfg_save(&g_config);
 }
 
 #ifdef DEBUG
-static void log_dew_debug(int32_t margin_centi, uint8_t duty) {
+static void log_dew_debug(int32_t margin_centi, uint16_t duty) {
   out('!');
   out(F("dew margin="));
   out(margin_centi / 100);
@@ -181,13 +157,127 @@ static void log_dew_debug(int32_t margin_centi, uint8_t duty) {
     out('0');
   out(frac);
   out(F("C duty="));
-  out(duty);
+  out((uint32_t)duty);
   out(F(" ("));
-  out((int32_t)((duty * 100L + 127) / 255));
+  out((int32_t)((duty * 100L + PWM_LEVEL_MAX / 2) / PWM_LEVEL_MAX));
   out(F("%)"));
   out('\n');
 }
 #endif
+// ---- Tasks ----
+// Each task does one job per run; scheduler_run picks at most one per loop
+// iteration so commands are served in between.
+
+static void task_ramp(unsigned long, uint32_t dt_ms) {
+  if (ports_update_ramps(&g_ports, dt_ms) > 0)
+    save_pwm_levels(&g_ports);
+}
+
+// Input readings, overvoltage check and one port's current; the sense mux is
+// then moved on so it settles before the next run.
+static void task_measure(unsigned long, uint32_t) {
+  ports_update_input_readings(&g_ports);
+  if (ports_overvoltage(&g_ports)) {
+    // Outputs first; logging and the save below take milliseconds.
+    ports_all_off(&g_ports);
+    if (!g_overvoltage_tripped) {
+      int32_t dv = ports_get_input_mv(&g_ports) / 100;
+      eventlog_record(EVENT_OVERVOLTAGE, (uint8_t)(dv > 255 ? 255 : dv));
+      g_overvoltage_tripped = true;
+      g_config.portStatus = g_ports.state;
+      for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+        g_config.pwmPorts[i] = g_ports.pwm_level[i];
+        g_config.pwmPortMode[i] = g_ports.pwm_mode[i];
+      }
+      // The supply is out of range; don't leave the shutdown state pending.
+      // Saved once per trip: the outputs stay off until the supply recovers.
+      eeprom_cfg_save(&g_config);
+      eeprom_cfg_flush();
+    }
+  } else {
+    g_overvoltage_tripped = false;
+  }
+  ports_update_port_current(&g_ports, g_port_index);
+  adc_swap_ports();
+}
+
+// Starts a sensor read; probes_update advances it from loop().
+static void task_sensor(unsigned long, uint32_t) {
+  probes_start(&g_probes);
+}
+
+static void task_trend(unsigned long, uint32_t) {
+  if (g_ports.have_temp)
+    trend_add(&g_trend, g_ports.temp_centi, g_ports.humid_centi);
+}
+
+static void task_dew(unsigned long, uint32_t dt_ms) {
+  if (g_ports.have_temp)
+    update_dew_control(&g_ports, dt_ms);
+}
+
+static void task_history(unsigned long, uint32_t) {
+  history_record(&g_history, &g_ports);
+}
+
+static void task_mcp_verify(unsigned long, uint32_t) {
+  ports_verify_outputs(&g_ports);
+}
+
+static void task_persist(unsigned long now, uint32_t) {
+  eeprom_cfg_update(now);
+}
+
+#ifdef DEBUG
+static void task_dew_log(unsigned long, uint32_t) {
+  log_dew_debug(g_ports.temp_centi - g_ports.dewpoint_centi, ports_max_dew_duty(&g_ports));
+}
+#endif
+
+enum TaskId : uint8_t {
+  TASK_RAMP = 0,
+  TASK_MEASURE,
+  TASK_SENSOR,
+  TASK_TREND,
+  TASK_DEW,
+  TASK_HISTORY,
+  TASK_MCP_VERIFY,
+  TASK_PERSIST,
+#ifdef DEBUG
+  TASK_DEW_LOG,
+#endif
+  TASK_COUNT,
+};
+
+// An EEPROM byte takes about 3.4 ms to write; tasks that may write carry
+// that in their budget. Sensor and dew periods follow the sample interval.
+static const TaskDef TASKS[TASK_COUNT] PROGMEM = {
+    {task_ramp, PWM_RAMP_STEP_MS, 500},
+    {task_measure, REFRESH, 2000},
+    {task_sensor, SENSOR_INTERVAL_MIN_MS, 100},
+    {task_trend, TREND_INTERVAL_MS, 500},
+    {task_dew, SENSOR_INTERVAL_MIN_MS * DEW_CONTROL_SAMPLES, 3000},
+#if HISTORY_EEPROM_SPILL
+    {task_history, HISTORY_INTERVAL_MS, 12 * 3400UL},
+#else
+    {task_history, HISTORY_INTERVAL_MS, 500},
+#endif
+    {task_mcp_verify, MCP_VERIFY_MS, 3000},
+    {task_persist, CONFIG_SAVE_POLL_MS, CONFIG_SLOT_SIZE * 3400UL},
+#ifdef DEBUG
+    {task_dew_log, DEBUG_DEW_LOG_INTERVAL_MS, 5000},
+#endif
+};
+static TaskState g_task_state[TASK_COUNT];
+Scheduler g_scheduler = {TASKS, g_task_state, TASK_COUNT};
+
+// The sensor and dew tasks run at the adaptive sample interval.
+static void update_sample_periods() {
+  uint32_t interval = g_ports.sample_interval_ms;
+  scheduler_set_period(&g_scheduler, TASK_SENSOR, interval);
+  scheduler_set_period(&g_scheduler, TASK_DEW, interval * DEW_CONTROL_SAMPLES);
+}
+
 static void init_board_pins() {
   pinMode(ISIN, INPUT);
   pinMode(VSIN, INPUT);
@@ -201,126 +291,93 @@ static void init_board_pins() {
 
   // Disable open-load diagnostics by default to avoid floating output voltage.
   digitalWrite(OLEN, LOW);
-  digitalWrite(MUX0, LOW);
-  digitalWrite(MUX1, LOW);
-  digitalWrite(MUX2, LOW);
-  digitalWrite(DSEL, HIGH);
+  select_sense_channel(0);
 }
 
 void setup() {
   Serial.begin(SERIALPORTSPEED);
-  Wire.begin();
-  Wire.setClock(100000);
+  i2c_init();
 
   init_board_pins();
 
+  eeprom_cfg_load(&g_config);
+  eeprom_wear_init();
+  eventlog_init();
   framing_init(&g_queue);
   ports_init(&g_ports);
-  eeprom_cfg_init(&g_config);
-  eeprom_name_init_defaults();
+  eeprom_cfg_init();
+  eeprom_name_init();
+  dew_curve_load(&g_dew_curve_settings);
+  dew_curve_build_all(g_dew_curves, &g_dew_curve_settings, &g_config);
   ports_update_input_readings(&g_ports);
   // Apply config to runtime state
-  for (uint8_t i = 0; i < PORT_COUNT; i++) {
-    bool on = (g_config.portStatus >> i) & 0x01;
-    g_ports.state[i] = on;
-  }
-  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
-    g_ports.pwm_level[i] = g_config.pwmPorts[i];
-    g_ports.pwm_mode[i] = g_config.pwmPortMode[i];
-  }
+  ports_load(&g_ports, &g_config.portStatus, g_config.pwmPorts, g_config.pwmPortMode);
+  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++)
+    g_ports.ramp_pct_s[i] = g_config.ramp_pct_s[i];
+  g_ports.sample_interval_ms = g_config.sample_min_ms;
+  g_probes.fusion = g_config.ambient_fusion;
+  g_probes.primary_addr = g_config.ambient_primary;
   if (!ports_overvoltage(&g_ports)) {
     ports_apply_config(&g_ports);
   } else {
     ports_all_off(&g_ports);
   }
-  g_last_refresh = millis();
+  ports_flush_outputs(&g_ports);
   g_port_index = 0;
-  g_chip = 0;
-  g_dsel = true;
-  g_last_sensor_ms = millis();
-  g_last_dew_ms = millis();
-  g_last_dewpoint_ms = millis();
-#ifdef DEBUG
-  g_last_dew_log_ms = millis();
-#endif
+  history_init(&g_history);
+  trend_reset(&g_trend);
+  scheduler_start(&g_scheduler, millis());
+  update_sample_periods();
 
   strncpy(g_board_signature, BOARD_SIGNATURE_BASE, BOARD_SIGNATURE_MAX_LEN);
   g_board_signature[BOARD_SIGNATURE_MAX_LEN - 1] = '\0';
   probes_detect(&g_probes, &g_ports);
+  i2c_update_clock();
+  // Configured dew modes wait for a probe to be plugged in.
+  if (!g_ports.have_temp)
+    ports_suspend_dew_mode(&g_ports);
 }
 
 void loop() {
+  timing_loop_mark();
   framing_poll(&g_queue);
 
   unsigned long now = millis();
-  if ((now - g_last_refresh) >= REFRESH) {
-    g_state = STATE_READ;
-    g_last_refresh = now;
+  // Sensor conversions are advanced every iteration so a read never blocks
+  // command handling; each step is at most one short I2C transaction.
+  unsigned long probe_us = timing_start();
+  ProbeStatus probe = probes_update(&g_probes, &g_ports);
+  if (probe != PROBE_IDLE)
+    timing_stop(TIME_PROBES, probe_us);
+  if (probe == PROBE_DONE) {
+    g_ports.dewpoint_centi = dewpoint_centi(g_ports.temp_centi, g_ports.humid_centi);
+    // The dew controller may have moved the sample interval.
+    update_sample_periods();
+  } else if (probe == PROBE_FAIL && g_ports.have_temp) {
+    // The stored config keeps the dew modes so they come back with the probe.
+    uint8_t suspended = ports_suspend_dew_mode(&g_ports);
+    if (suspended > 0)
+      eventlog_record(EVENT_DEW_DISABLED, suspended);
+    // Stale readings would flatten the trend; start over once reads recover.
+    trend_reset(&g_trend);
+    probes_lost(&g_probes, &g_ports);
   }
-
-  switch (g_state) {
-  case STATE_IDLE: {
-    if (framing_has_command(&g_queue)) {
-      char cmd[MAXCOMMAND];
-      if (framing_pop(&g_queue, cmd)) {
-        protocol_handle(cmd, &g_ports);
-      }
-    }
-    break;
+  if (probes_rescan(&g_probes, &g_ports)) {
+    i2c_update_clock();
+    eventlog_record(EVENT_PROBE_RESTORED, ports_resume_dew_mode(&g_ports));
+    scheduler_trigger(&g_scheduler, TASK_SENSOR, now);
   }
-  case STATE_READ:
-    ports_update_input_readings(&g_ports);
-    if (ports_overvoltage(&g_ports)) {
-      ports_all_off(&g_ports);
-      g_config.portStatus = 0;
-      for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
-        g_config.pwmPorts[i] = g_ports.pwm_level[i];
-        g_config.pwmPortMode[i] = g_ports.pwm_mode[i];
-      }
-      eeprom_cfg_save(&g_config);
-    }
-    ports_update_port_current(&g_ports, g_port_index);
-    if ((now - g_last_sensor_ms) >= SENSOR_READ_INTERVAL_MS) {
-      bool ok = probes_update(&g_probes, &g_ports);
-      if (!ok && g_ports.have_temp) {
-        ports_disable_dew_mode(&g_ports);
-        // Persist config after disabling dew mode.
-        for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
-          g_config.pwmPortMode[i] = g_ports.pwm_mode[i];
-          g_config.pwmPorts[i] = g_ports.pwm_level[i];
-        }
-        eeprom_cfg_save(&g_config);
-      }
-      g_last_sensor_ms = now;
-    }
 
-    if ((now - g_last_dew_ms) >= 10000) {
-      if (g_ports.have_temp) {
-        update_dew_control(&g_ports);
-      }
-      g_last_dew_ms = now;
+  if (framing_has_command(&g_queue)) {
+    char cmd[MAXCOMMAND];
+    if (framing_pop(&g_queue, cmd)) {
+      TimingScope timing(TIME_COMMAND);
+      protocol_handle(cmd, &g_ports);
     }
+  }
 
-    if ((now - g_last_dewpoint_ms) >= 10000) {
-      if (g_ports.have_temp) {
-        int32_t margin = dew_margin_centi(g_ports.temp_centi, g_ports.humid_centi);
-        g_ports.dewpoint_centi = g_ports.temp_centi - margin;
-      }
-      g_last_dewpoint_ms = now;
-    }
+  scheduler_run(&g_scheduler, now);
 
-#ifdef DEBUG
-    if ((now - g_last_dew_log_ms) >= DEBUG_DEW_LOG_INTERVAL_MS) {
-      int32_t margin = dew_margin_centi(g_ports.temp_centi, g_ports.humid_centi);
-      log_dew_debug(margin, g_ports.dew_duty);
-      g_last_dew_log_ms = now;
-    }
-#endif
-    g_state = STATE_SWAP;
-    break;
-  case STATE_SWAP:
-    adc_swap_ports(PORT_COUNT);
-    g_state = STATE_IDLE;
-    break;
-  }
+  // Expander pin changes made anywhere above go out as one latch write.
+  ports_flush_outputs(&g_ports);
 }
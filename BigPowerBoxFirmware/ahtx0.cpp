@@ -2,36 +2,63 @@
 
 #include "i2c_bus.h"
 
-bool ahtx0_init(Ahtx0* a, uint8_t addr) {
+namespace {
+constexpr unsigned long POLL_MS = 10;
+constexpr unsigned long TIMEOUT_MS = 200;
+constexpr unsigned long POWER_UP_MS = 50;
+constexpr unsigned long CALIBRATE_MS = 10;
+} // namespace
+
+void ahtx0_init_start(Ahtx0* a, uint8_t addr) {
   if (!a)
-    return false;
+    return;
   a->addr = addr;
-  delay(50);
-  uint8_t cmd[3] = {0xBE, 0x08, 0x00};
-  if (!i2c_write(a->addr, cmd, 3))
-    return false;
-  delay(10);
-  return true;
+  a->init_step = 0;
+  a->trigger_ms = 0;
+  a->poll_ms = millis();
 }
 
-bool ahtx0_read(Ahtx0* a, int16_t* t_centi, uint16_t* rh_centi) {
-  if (!a || !t_centi || !rh_centi)
+SensorStatus ahtx0_init_poll(Ahtx0* a) {
+  if (!a)
+    return SENSOR_ERROR;
+  unsigned long now = millis();
+  if (a->init_step == 0) {
+    if ((now - a->poll_ms) < POWER_UP_MS)
+      return SENSOR_BUSY;
+    uint8_t cmd[3] = {0xBE, 0x08, 0x00};
+    if (!i2c_write(a->addr, cmd, 3))
+      return SENSOR_ERROR;
+    a->init_step = 1;
+    a->poll_ms = now;
+    return SENSOR_BUSY;
+  }
+  return (now - a->poll_ms) < CALIBRATE_MS ? SENSOR_BUSY : SENSOR_DONE;
+}
+
+bool ahtx0_trigger(Ahtx0* a) {
+  if (!a)
     return false;
   uint8_t trig[3] = {0xAC, 0x33, 0x00};
   if (!i2c_write(a->addr, trig, 3))
     return false;
+  a->trigger_ms = millis();
+  a->poll_ms = a->trigger_ms;
+  return true;
+}
+
+SensorStatus ahtx0_collect(Ahtx0* a, int16_t* t_centi, uint16_t* rh_centi) {
+  if (!a || !t_centi || !rh_centi)
+    return SENSOR_ERROR;
+  unsigned long now = millis();
+  if ((now - a->poll_ms) < POLL_MS)
+    return SENSOR_BUSY;
+  a->poll_ms = now;
 
-  const uint32_t t0 = millis();
   uint8_t buf[6];
-  while (true) {
-    delay(10);
-    if (!i2c_read(a->addr, buf, 6))
-      return false;
-    if ((buf[0] & 0x80) == 0)
-      break;
-    if (millis() - t0 > 200)
-      return false;
-  }
+  if (!i2c_read(a->addr, buf, 6))
+    return SENSOR_ERROR;
+  if (buf[0] & 0x80)
+    return (now - a->trigger_ms) > TIMEOUT_MS ? SENSOR_ERROR : SENSOR_BUSY;
 
   uint32_t raw_h =
     ((uint32_t)buf[1] << 12) | ((uint32_t)buf[2] << 4) | ((uint32_t)(buf[3] >> 4) & 0x0F);
@@ -46,5 +73,5 @@ bool ahtx0_read(Ahtx0* a, int16_t* t_centi, uint16_t* rh_centi) {
   int32_t tc = (int32_t)(((uint64_t)raw_t * 20000ULL) >> 20) - 5000;
   *t_centi = (int16_t)tc;
 
-  return true;
+  return SENSOR_DONE;
 }
@@ -2,9 +2,20 @@
 
 #include <Arduino.h>
 
+#include "sensor_status.h"
+
 struct Ahtx0 {
   uint8_t addr;
+  uint8_t init_step;
+  unsigned long trigger_ms;
+  unsigned long poll_ms;
 };
 
-bool ahtx0_init(Ahtx0* a, uint8_t addr);
-bool ahtx0_read(Ahtx0* a, int16_t* t_centi, uint16_t* rh_centi);
+// Waits out the power-up time, sends the calibrate command and waits for it
+// to complete; ahtx0_init_poll reports SENSOR_DONE when the sensor is ready.
+void ahtx0_init_start(Ahtx0* a, uint8_t addr);
+SensorStatus ahtx0_init_poll(Ahtx0* a);
+// Starts a conversion; ahtx0_collect polls the busy bit at most once every
+// 10 ms and gives up 200 ms after the trigger.
+bool ahtx0_trigger(Ahtx0* a);
+SensorStatus ahtx0_collect(Ahtx0* a, int16_t* t_centi, uint16_t* rh_centi);
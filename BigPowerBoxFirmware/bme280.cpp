@@ -9,9 +9,22 @@ uint16_t u16le(const uint8_t* p) {
 int16_t s16le(const uint8_t* p) {
   return (int16_t)u16le(p);
 }
+
+// Register writes that start normal mode, one per init step. ctrl_hum only
+// takes effect after the following ctrl_meas write.
+const uint8_t CONFIG_WRITES[][2] = {
+  {0xF5, 0x64}, // 250 ms standby, IIR filter x2
+  {0xF2, 0x01}, // humidity x1
+  {0xF4, 0x27}, // temp/press x1, normal mode
+};
+constexpr uint8_t CONFIG_WRITE_COUNT = sizeof(CONFIG_WRITES) / sizeof(CONFIG_WRITES[0]);
+// Steps before the config writes: chip ID and the two calibration blocks.
+constexpr uint8_t CONFIG_STEP = 3;
+// Time for the first conversion after normal mode starts.
+constexpr unsigned long SETTLE_MS = 10;
 } // namespace
 
-static bool bme280_read_cal(Bme280* b) {
+static bool bme280_read_cal_tp(Bme280* b) {
   uint8_t buf1[26];
   if (!i2c_read_reg(b->addr, 0x88, buf1, 26))
     return false;
@@ -28,7 +41,10 @@ static bool bme280_read_cal(Bme280* b) {
   b->cal.dig_P8 = s16le(&buf1[20]);
   b->cal.dig_P9 = s16le(&buf1[22]);
   b->cal.dig_H1 = buf1[25];
+  return true;
+}
 
+static bool bme280_read_cal_h(Bme280* b) {
   uint8_t buf2[7];
   if (!i2c_read_reg(b->addr, 0xE1, buf2, 7))
     return false;
@@ -40,28 +56,38 @@ static bool bme280_read_cal(Bme280* b) {
   return true;
 }
 
-bool bme280_init(Bme280* b, uint8_t addr) {
+void bme280_init_start(Bme280* b, uint8_t addr) {
   if (!b)
-    return false;
+    return;
   b->addr = addr;
-  uint8_t id = 0;
-  if (!i2c_read_reg(addr, 0xD0, &id, 1))
-    return false;
-  if (id != 0x60)
-    return false;
-  if (!bme280_read_cal(b))
-    return false;
-  uint8_t cfg = 0x00;
-  uint8_t ctrl_hum = 0x01;  // humidity x1
-  uint8_t ctrl_meas = 0x27; // temp/press x1, normal mode
-  if (!i2c_write_reg(addr, 0xF5, &cfg, 1))
-    return false;
-  if (!i2c_write_reg(addr, 0xF2, &ctrl_hum, 1))
-    return false;
-  if (!i2c_write_reg(addr, 0xF4, &ctrl_meas, 1))
-    return false;
-  delay(10);
-  return true;
+  b->init_step = 0;
+  b->init_ms = 0;
+}
+
+SensorStatus bme280_init_poll(Bme280* b) {
+  if (!b)
+    return SENSOR_ERROR;
+  uint8_t step = b->init_step;
+  if (step == 0) {
+    uint8_t id = 0;
+    if (!i2c_read_reg(b->addr, 0xD0, &id, 1) || id != 0x60)
+      return SENSOR_ERROR;
+  } else if (step == 1) {
+    if (!bme280_read_cal_tp(b))
+      return SENSOR_ERROR;
+  } else if (step == 2) {
+    if (!bme280_read_cal_h(b))
+      return SENSOR_ERROR;
+  } else if (step < CONFIG_STEP + CONFIG_WRITE_COUNT) {
+    const uint8_t* w = CONFIG_WRITES[step - CONFIG_STEP];
+    if (!i2c_write_reg(b->addr, w[0], &w[1], 1))
+      return SENSOR_ERROR;
+    b->init_ms = millis();
+  } else {
+    return (millis() - b->init_ms) < SETTLE_MS ? SENSOR_BUSY : SENSOR_DONE;
+  }
+  b->init_step++;
+  return SENSOR_BUSY;
 }
 
 static int32_t bme280_compensate_temp(Bme280* b, int32_t adc_T) {
@@ -121,14 +147,6 @@ static uint16_t bme280_compensate_humidity(Bme280* b, int32_t adc_H) {
 bool bme280_read(Bme280* b, int16_t* t_centi, uint16_t* rh_centi, uint32_t* p_pa) {
   if (!b || !t_centi || !rh_centi || !p_pa)
     return false;
-  uint8_t ctrl_hum = 0x01;
-  uint8_t ctrl_meas = 0x27;
-  if (!i2c_write_reg(b->addr, 0xF2, &ctrl_hum, 1))
-    return false;
-  if (!i2c_write_reg(b->addr, 0xF4, &ctrl_meas, 1))
-    return false;
-  delay(10);
-
   uint8_t buf[8];
   if (!i2c_read_reg(b->addr, 0xF7, buf, 8))
     return false;
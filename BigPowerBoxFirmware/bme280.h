@@ -2,6 +2,8 @@
 
 #include <Arduino.h>
 
+#include "sensor_status.h"
+
 struct Bme280Cal {
   uint16_t dig_T1;
   int16_t dig_T2;
@@ -25,9 +27,17 @@ struct Bme280Cal {
 
 struct Bme280 {
   uint8_t addr;
+  uint8_t init_step;
+  unsigned long init_ms;
   Bme280Cal cal;
   int32_t t_fine;
 };
 
-bool bme280_init(Bme280* b, uint8_t addr);
+// Checks the chip ID, reads the calibration and starts normal mode, one
+// register transfer per bme280_init_poll call; SENSOR_DONE once the first
+// result is ready.
+void bme280_init_start(Bme280* b, uint8_t addr);
+SensorStatus bme280_init_poll(Bme280* b);
+// The chip free-runs in normal mode after init; a read is a single burst of
+// the latest filtered result.
 bool bme280_read(Bme280* b, int16_t* t_centi, uint16_t* rh_centi, uint32_t* p_pa);
@@ -9,6 +9,17 @@ uint16_t u16le(const uint8_t* p) {
 int16_t s16le(const uint8_t* p) {
   return (int16_t)u16le(p);
 }
+
+// Register writes that start normal mode, one per init step.
+const uint8_t CONFIG_WRITES[][2] = {
+  {0xF5, 0x00}, // 0.5 ms standby, filter off
+  {0xF4, 0x27}, // temp/press x1, normal mode
+};
+constexpr uint8_t CONFIG_WRITE_COUNT = sizeof(CONFIG_WRITES) / sizeof(CONFIG_WRITES[0]);
+// Steps before the config writes: chip ID and the calibration block.
+constexpr uint8_t CONFIG_STEP = 2;
+// Time for the first conversion after normal mode starts.
+constexpr unsigned long SETTLE_MS = 10;
 } // namespace
 
 static bool bmp280_read_cal(Bmp280* b) {
@@ -30,25 +41,35 @@ static bool bmp280_read_cal(Bmp280* b) {
   return true;
 }
 
-bool bmp280_init(Bmp280* b, uint8_t addr) {
+void bmp280_init_start(Bmp280* b, uint8_t addr) {
   if (!b)
-    return false;
+    return;
   b->addr = addr;
-  uint8_t id = 0;
-  if (!i2c_read_reg(addr, 0xD0, &id, 1))
-    return false;
-  if (id != 0x58)
-    return false;
-  if (!bmp280_read_cal(b))
-    return false;
-  uint8_t cfg = 0x00;
-  uint8_t ctrl = 0x27; // temp/press x1, normal mode
-  if (!i2c_write_reg(addr, 0xF5, &cfg, 1))
-    return false;
-  if (!i2c_write_reg(addr, 0xF4, &ctrl, 1))
-    return false;
-  delay(10);
-  return true;
+  b->init_step = 0;
+  b->init_ms = 0;
+}
+
+SensorStatus bmp280_init_poll(Bmp280* b) {
+  if (!b)
+    return SENSOR_ERROR;
+  uint8_t step = b->init_step;
+  if (step == 0) {
+    uint8_t id = 0;
+    if (!i2c_read_reg(b->addr, 0xD0, &id, 1) || id != 0x58)
+      return SENSOR_ERROR;
+  } else if (step == 1) {
+    if (!bmp280_read_cal(b))
+      return SENSOR_ERROR;
+  } else if (step < CONFIG_STEP + CONFIG_WRITE_COUNT) {
+    const uint8_t* w = CONFIG_WRITES[step - CONFIG_STEP];
+    if (!i2c_write_reg(b->addr, w[0], &w[1], 1))
+      return SENSOR_ERROR;
+    b->init_ms = millis();
+  } else {
+    return (millis() - b->init_ms) < SETTLE_MS ? SENSOR_BUSY : SENSOR_DONE;
+  }
+  b->init_step++;
+  return SENSOR_BUSY;
 }
 
 static int32_t bmp280_compensate_temp(Bmp280* b, int32_t adc_T) {
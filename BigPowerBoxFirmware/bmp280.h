@@ -2,6 +2,8 @@
 
 #include <Arduino.h>
 
+#include "sensor_status.h"
+
 struct Bmp280Cal {
   uint16_t dig_T1;
   int16_t dig_T2;
@@ -19,9 +21,15 @@ struct Bmp280Cal {
 
 struct Bmp280 {
   uint8_t addr;
+  uint8_t init_step;
+  unsigned long init_ms;
   Bmp280Cal cal;
   int32_t t_fine;
 };
 
-bool bmp280_init(Bmp280* b, uint8_t addr);
+// Checks the chip ID, reads the calibration and starts normal mode, one
+// register transfer per bmp280_init_poll call; SENSOR_DONE once the first
+// result is ready.
+void bmp280_init_start(Bmp280* b, uint8_t addr);
+SensorStatus bmp280_init_poll(Bmp280* b);
 bool bmp280_read(Bmp280* b, int16_t* t_centi, uint32_t* p_pa);
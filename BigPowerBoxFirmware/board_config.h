@@ -18,9 +18,29 @@
 #define SOCOMMAND '>'
 #define EOCOMMAND '#'
 #define NAMELENGTH 16
+// Maximum number of ':'-separated tokens in a command, including the command.
+#define MAXARGS 6
 
-// ---- FSM timing ----
+// ---- Task timing ----
+// Period of the measurement task (input readings, one port current).
 #define REFRESH 200
+// Set to 1 to time command handling, sensor steps, config writes and every
+// task with micros() and keep a histogram of the loop period (`Y:TIME`).
+// Costs about 16 bytes of RAM per section and task.
+#define TIMING_STATS 0
+// Loop period bins: the first counts periods under TIMING_LOOP_BIN0_US, each
+// further bin doubles the bound, and the last counts everything longer.
+#define TIMING_LOOP_BINS 10
+#define TIMING_LOOP_BIN0_US 128
+
+// ---- Memory ----
+// Free RAM is filled with this byte at boot; `Y:STACK` counts what is left.
+#define STACK_PAINT_BYTE 0xC5
+// Budgets checked by tools/size_check.sh after a build. Flash leaves room for
+// a 2 KB bootloader; static RAM (.data + .bss) leaves 384 bytes of the 2 KB
+// for the stack.
+#define FLASH_BUDGET_BYTES 30720
+#define STATIC_RAM_BUDGET_BYTES 1664
 
 // ---- Firmware identity ----
 static const char PROGRAM_NAME[] = "BigPowerBox";
@@ -29,29 +49,67 @@ static const char PROGRAM_VERSION[] = "013";
 // ---- Board signature (must match original hardware) ----
 //  m: MCP23017-controlled switch port
 //  p: PWM port
+//  s: switch port on an Arduino pin
 //  a: always-on port (not switchable)
 //  f: temp + humidity probe
 //  g: temp + humidity + pressure probe
+// The signature, ports2Pin and ports2Mux below describe the board; the port
+// tables in board_model.h are generated from them at compile time.
 #define BOARD_SIGNATURE_BASE "mmmmmmmmppppaa"
 static constexpr uint8_t PORT_COUNT = sizeof(BOARD_SIGNATURE_BASE) - 1;
 static constexpr uint8_t BOARD_SIGNATURE_MAX_LEN = PORT_COUNT + 2;
 extern char g_board_signature[BOARD_SIGNATURE_MAX_LEN];
-static constexpr uint8_t PWM_PORT_COUNT = 4;
+
+// Number of signature entries of the given type among the first `end` ports.
+constexpr uint8_t board_count_type(char type, uint8_t end) {
+  return end == 0 ? 0
+                  : (uint8_t)(board_count_type(type, end - 1) +
+                              (BOARD_SIGNATURE_BASE[end - 1] == type ? 1 : 0));
+}
+static constexpr uint8_t PWM_PORT_COUNT = board_count_type('p', PORT_COUNT);
 
 // ---- PWM modes ----
 #define PWM_MODE_VARIABLE 0
 #define PWM_MODE_SWITCHABLE 1
 #define PWM_MODE_DEW_AMBIENT 2
+#define PWM_MODE_DEW_PI 3
+
+// ---- Heater PWM ----
+// Output levels run 0..PWM_LEVEL_MAX (10-bit). Timer1 ticks at F_CPU / 8 and
+// edges within PWM_EDGE_SLACK_TICKS of each other are switched together.
+#define PWM_LEVEL_MAX 1023
+#define PWM_FREQUENCY_HZ 100
+#define PWM_PERIOD_TICKS (F_CPU / 8 / PWM_FREQUENCY_HZ)
+#define PWM_EDGE_SLACK_TICKS 10
+// Soft start: default ramp rate in percent of full scale per second (0 = off)
+// and how often the ramp advances.
+#define PWM_RAMP_DEFAULT_PCT_S 25
+#define PWM_RAMP_STEP_MS 20
+
+// ---- MCP23017 expanders ----
+// Expanders on the I2C bus, in the order used by MCP_PIN. Each drives up to
+// 16 ports: pins 0..7 are GPA0..GPA7 and 8..15 are GPB0..GPB7.
+#define MCP23017_BASE_ADDR 0x20
+static const uint8_t MCP23017_ADDRS[] = {0x20};
+static constexpr uint8_t MCP23017_COUNT = sizeof(MCP23017_ADDRS);
+static_assert(MCP23017_COUNT >= 1 && MCP23017_COUNT <= 8, "MCP23017 has eight addresses");
+// Pin of an 'm' port: expander index in the high nibble, expander pin in the
+// low nibble.
+#define MCP_PIN(expander, pin) ((uint8_t)(((expander) << 4) | (pin)))
+// Output latches are read back at this interval and rewritten if an
+// expander lost them (e.g. after a brown-out reset).
+#define MCP_VERIFY_MS 1000
+// Entry for ports without a pin of their own ('a').
+#define PORT_NO_PIN 0xFF
 
-// ---- MCP23017 pins (GPA0..GPA7) ----
-#define PORT1EN 0
-#define PORT2EN 1
-#define PORT3EN 2
-#define PORT4EN 3
-#define PORT5EN 4
-#define PORT6EN 5
-#define PORT7EN 6
-#define PORT8EN 7
+#define PORT1EN MCP_PIN(0, 0)
+#define PORT2EN MCP_PIN(0, 1)
+#define PORT3EN MCP_PIN(0, 2)
+#define PORT4EN MCP_PIN(0, 3)
+#define PORT5EN MCP_PIN(0, 4)
+#define PORT6EN MCP_PIN(0, 5)
+#define PORT7EN MCP_PIN(0, 6)
+#define PORT8EN MCP_PIN(0, 7)
 
 // ---- PWM pins (Arduino) ----
 #define PORT9EN 3
@@ -59,8 +117,12 @@ static constexpr uint8_t PWM_PORT_COUNT = 4;
 #define PORT11EN 6
 #define PORT12EN 9
 
-static const uint8_t ports2Pin[12] = {PORT1EN, PORT2EN, PORT3EN, PORT4EN,  PORT5EN,  PORT6EN,
-                                      PORT7EN, PORT8EN, PORT9EN, PORT10EN, PORT11EN, PORT12EN};
+// One entry per signature character: expander pin for 'm', Arduino pin for
+// 'p' and 's'.
+static constexpr uint8_t ports2Pin[] = {PORT1EN, PORT2EN,  PORT3EN,  PORT4EN,  PORT5EN,
+                                    PORT6EN, PORT7EN,  PORT8EN,  PORT9EN,  PORT10EN,
+                                    PORT11EN, PORT12EN, PORT_NO_PIN, PORT_NO_PIN};
+static_assert(sizeof(ports2Pin) == PORT_COUNT, "ports2Pin needs one entry per port");
 
 // ---- Analog inputs (kept for pin compatibility) ----
 #define ISIN A2
@@ -74,8 +136,25 @@ static const uint8_t ports2Pin[12] = {PORT1EN, PORT2EN, PORT3EN, PORT4EN,  PORT5
 #define MUX2 12
 #define OLEN 2
 
-// ---- MCP23017 address ----
-#define MCP23017_ADDR 0x20
+// Current-sense channel of each port: mux chip select on MUX0..MUX2 and the
+// DSEL level. The second always-on port is wired to chip 7, not chip 6.
+#define MUX_CH(chip, dsel) ((uint8_t)(((chip) << 1) | (dsel)))
+static constexpr uint8_t ports2Mux[] = {
+    MUX_CH(0, 1), MUX_CH(0, 0), MUX_CH(1, 1), MUX_CH(1, 0), MUX_CH(2, 1),
+    MUX_CH(2, 0), MUX_CH(3, 1), MUX_CH(3, 0), MUX_CH(4, 1), MUX_CH(4, 0),
+    MUX_CH(5, 1), MUX_CH(5, 0), MUX_CH(6, 1), MUX_CH(7, 0)};
+
+// ---- I2C bus ----
+// The bus starts at the standard clock and moves to the fast clock once every
+// device that has answered is known to support it. After a bus recovery it
+// stays at the standard clock. Set I2C_FAST_CLOCK_HZ to I2C_CLOCK_HZ to
+// disable fast mode.
+#define I2C_CLOCK_HZ 100000
+#define I2C_FAST_CLOCK_HZ 400000
+// A transaction that takes longer than this is aborted and the bus recovered.
+#define I2C_TIMEOUT_US 25000
+// Per-address transaction counters reported by `Y:I2C`.
+#define I2C_STATS_SLOTS 12
 
 // ---- ADC calibration (match original hardware constants) ----
 // VCC in millivolts.
@@ -85,25 +164,147 @@ static const uint8_t ports2Pin[12] = {PORT1EN, PORT2EN, PORT3EN, PORT4EN,  PORT5
 
 // ---- Sensor EMA smoothing (fixed-point alpha, 0..256) ----
 #define SENSOR_EMA_ALPHA 32
-// Sensor read interval in milliseconds.
-#define SENSOR_READ_INTERVAL_MS 1000
+// Adaptive sensor read interval: the minimum applies within
+// SAMPLE_NEAR_CENTI of the highest dew on-margin and stretches linearly to the
+// maximum at SAMPLE_FAR_CENTI. Min/max are defaults for `I`, which accepts
+// SENSOR_INTERVAL_FLOOR_MS..SENSOR_INTERVAL_CEIL_MS.
+#define SENSOR_INTERVAL_MIN_MS 1000
+#define SENSOR_INTERVAL_MAX_MS 10000
+#define SENSOR_INTERVAL_FLOOR_MS 250
+#define SENSOR_INTERVAL_CEIL_MS 60000
+#define SAMPLE_NEAR_CENTI 100
+#define SAMPLE_FAR_CENTI 1000
+// While no ambient probe answers, its addresses are rescanned one per loop
+// pass. The pause between full scans starts at the minimum and doubles after
+// each empty scan up to the maximum.
+#define PROBE_RESCAN_MIN_MS 1000
+#define PROBE_RESCAN_MAX_MS 60000
+// Up to this many ambient probes are read each cycle and fused into one
+// temperature/humidity pair.
+#define AMBIENT_MAX 3
+// Fusion modes for `E`: first working probe (or the chosen primary), the probe
+// with the smallest dew margin, or the mean of all working probes.
+#define FUSION_PRIMARY 0
+#define FUSION_MIN_MARGIN 1
+#define FUSION_AVERAGE 2
 
 // ---- Ambient dew control defaults ----
 // Margin thresholds in centi-degC.
 #define DEW_M_ON_CENTI 300
-#define DEW_M_OFF_CENTI 350
+// Heating stops once the margin rises this far above the on-margin.
+#define DEW_M_HYST_CENTI 50
 #define DEW_M_FULL_CENTI 50
 // Duty cycle bounds in percent.
 #define DEW_DUTY_MIN_PCT 20
 #define DEW_DUTY_MAX_AUTO_PCT 80
-// Slew rate limit per update in percent.
+// Default slew rate limit per DEW_CONTROL_REF_MS in percent.
 #define DEW_DUTY_SLEW_STEP_PCT 10
+// Dew control runs once every DEW_CONTROL_SAMPLES sensor reads. Slew limits
+// and the PI integral gain are specified per DEW_CONTROL_REF_MS and scaled to
+// the actual update interval.
+#define DEW_CONTROL_SAMPLES 5
+#define DEW_CONTROL_REF_MS 10000
+// Closed-loop strap control (mode 3): Q8 PWM levels per centi-C of error,
+// integral term per DEW_CONTROL_REF_MS; error is clamped before use.
+#define DEW_PI_KP_Q8 240
+#define DEW_PI_KI_Q8 16
+#define DEW_PI_ERR_CLAMP_CENTI 1000
+// Optional TMP102-compatible strap sensor for PWM slot i sits at this address + i.
+#define STRAP_SENSOR_BASE_ADDR 0x48
+// Per-port margin-to-duty table resolution; covers margins up to 5.12 C.
+#define DEW_CURVE_STEP_CENTI 32
+#define DEW_CURVE_ENTRIES 17
+// Number of user-supplied curve breakpoints.
+#define DEW_CURVE_POINTS 6
+// Predictive pre-heat: ambient samples are taken every TREND_INTERVAL_MS and
+// the last TREND_DEPTH of them are extrapolated TREND_HORIZON_MS ahead. Dew
+// control acts on the projected margin whenever it is below the current one.
+#define TREND_INTERVAL_MS 30000UL
+#define TREND_DEPTH 16
+#define TREND_HORIZON_MS 300000UL
+// Samples required before a projection is used (3 minutes by default).
+#define TREND_MIN_SAMPLES 6
+
+// ---- Measurement history ----
+// Snapshot interval in milliseconds.
+#define HISTORY_INTERVAL_MS 60000
+// Number of snapshots kept in SRAM.
+#define HISTORY_DEPTH 12
+// Snapshots returned per `Q` reply.
+#define HISTORY_CHUNK 4
+// Set to 1 to spill evicted snapshots into an EEPROM ring.
+#define HISTORY_EEPROM_SPILL 0
+#define HISTORY_EEPROM_DEPTH 20
+
+// ---- Event log ----
+// Number of records in the EEPROM ring (power of two).
+#define EVENTLOG_DEPTH 16
+#define EVENTLOG_RECORD_SIZE 10
+// Identical consecutive events within this window are logged once.
+#define EVENTLOG_REPEAT_MS 600000UL
+// Records returned per `Y:LOG` reply.
+#define EVENTLOG_CHUNK 4
 
 // ---- EEPROM config ----
 #define EEPROMNAMEBASE 0
-#define EEPROMCONFBASE 224
-#define CURRENTCONFIGFLAG 99
-#define OLDCONFIGFLAG 0
+// Port names come first, then the config slots. Each name record is a port
+// tag, NAMELENGTH - 1 characters and a CRC-16; a renamed port moves to a
+// free record, so the region holds NAME_SPARE_RECORDS or more spares. The
+// region grows in whole config slots to keep the config slots where
+// firmware with fixed 16-byte name slots put them.
+#define NAME_RECORD_SIZE (NAMELENGTH + 2)
+#define NAME_SPARE_RECORDS 2
+// Bytes the region needs beyond the old fixed slots, rounded up to config slots.
+#define NAME_REGION_GROWTH                                                                         \
+  (((PORT_COUNT + NAME_SPARE_RECORDS) * NAME_RECORD_SIZE - PORT_COUNT * NAMELENGTH +               \
+    CONFIG_SLOT_SIZE - 1) /                                                                        \
+   CONFIG_SLOT_SIZE * CONFIG_SLOT_SIZE)
+#define EEPROMNAMESIZE (PORT_COUNT * NAMELENGTH + NAME_REGION_GROWTH)
+#define EEPROMCONFBASE (EEPROMNAMEBASE + EEPROMNAMESIZE)
+#define EEPROMSIZE 1024
+// Event log sits at the top of EEPROM: 3-byte header plus records.
+#define EEPROMLOGBASE (EEPROMSIZE - 3 - EVENTLOG_DEPTH * EVENTLOG_RECORD_SIZE)
+// Dew curve settings sit below the event log: magic, type, breakpoints.
+#define EEPROMCURVEBASE (EEPROMLOGBASE - 2 - DEW_CURVE_POINTS * 3)
+// Named profiles sit below the dew curve, one PROFILE_SLOT_SIZE slot each.
+#define EEPROMPROFILEBASE (EEPROMCURVEBASE - PROFILE_COUNT * PROFILE_SLOT_SIZE)
+// Per-region EEPROM write counters: CRC-16 and six 32-bit counts.
+#define EEPROMWEARSIZE 26
+#define EEPROMWEARBASE (EEPROMPROFILEBASE - EEPROMWEARSIZE)
+// The counters are stored after this many counted byte writes and on
+// eeprom_cfg_flush, so a power cut between those loses fewer than that many.
+#define EEPROM_WEAR_SAVE_BYTES 128
+#if HISTORY_EEPROM_SPILL
+// History ring sits below the write counters; 12 bytes per snapshot.
+#define EEPROMHISTBASE (EEPROMWEARBASE - HISTORY_EEPROM_DEPTH * 12)
+#define EEPROMCONFEND EEPROMHISTBASE
+#else
+#define EEPROMCONFEND EEPROMWEARBASE
+#endif
+// Config records carry a magic byte, schema version, length, sequence
+// number and CRC-16, one record per CONFIG_SLOT_SIZE slot. Bump
+// CONFIG_VERSION and add a migration step in eeprom_cfg.cpp when a Config
+// field is moved, resized or removed; appended fields need neither.
+#define CONFIG_RECORD_MAGIC 0xC5
+#define CONFIG_VERSION 2
+#define CONFIG_SLOT_SIZE 64
+// First byte of the records written before versioning (schema 1).
+#define LEGACY_CONFIG_FLAG 104
+// Flag byte of the first release's config records (schema 0).
+#define BASELINE_CONFIG_FLAG 99
+// Config changes are written once no further change has arrived for
+// CONFIG_SAVE_QUIET_MS, and at most CONFIG_SAVE_MAX_DELAY_MS after the first
+// unsaved change.
+#define CONFIG_SAVE_QUIET_MS 2000
+#define CONFIG_SAVE_MAX_DELAY_MS 10000UL
+// How often the persistence task checks for a config write that is due.
+#define CONFIG_SAVE_POLL_MS 250
+// Named profiles (port states, PWM levels and modes, dew settings) saved and
+// recalled with `B`. Names hold up to PROFILE_NAME_LENGTH - 1 characters.
+#define PROFILE_COUNT 3
+#define PROFILE_NAME_LENGTH 10
+#define PROFILE_SLOT_SIZE 48
+#define PROFILE_MAGIC 0xB5
 
 // ---- Voltage shutdown ----
 #define MAXINVOLTS 14.7
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+#include "board_config.h"
+#include "indices.h"
+#include "port_bits.h"
+
+// Port tables generated at compile time from the board description in
+// board_config.h (signature, ports2Pin, ports2Mux) and kept in flash, so every
+// per-port lookup is a single table read.
+
+struct BoardPort {
+  char type;
+  // Expander pin for 'm', Arduino pin for 'p' and 's'.
+  uint8_t pin;
+  // Compact index into the PWM arrays, -1 for other port types.
+  int8_t pwm_index;
+  // MUX_CH() current-sense channel.
+  uint8_t mux;
+};
+
+constexpr char board_type_ce(uint8_t port) {
+  return BOARD_SIGNATURE_BASE[port];
+}
+
+constexpr int8_t board_pwm_index_ce(uint8_t port) {
+  return board_type_ce(port) == 'p' ? (int8_t)board_count_type('p', port) : -1;
+}
+
+constexpr uint8_t board_pwm_port_ce(uint8_t pwm_index, uint8_t port) {
+  return port >= PORT_COUNT ? 0xFF
+         : board_pwm_index_ce(port) == (int8_t)pwm_index ? port
+                                                         : board_pwm_port_ce(pwm_index, port + 1);
+}
+
+// Bit b of byte `byte` set when port byte * 8 + b is of the given type.
+constexpr uint8_t board_type_bits_ce(char type, uint8_t byte, uint8_t bit) {
+  return bit == 8 ? 0
+                  : (uint8_t)(((byte * 8 + bit < PORT_COUNT && board_type_ce(byte * 8 + bit) == type)
+                                   ? (1u << bit)
+                                   : 0u) |
+                              board_type_bits_ce(type, byte, bit + 1));
+}
+
+// ---- Static checks on the board description ----
+
+constexpr bool board_port_ok_ce(uint8_t port) {
+  return (board_type_ce(port) == 'm' && (ports2Pin[port] >> 4) < MCP23017_COUNT) ||
+         ((board_type_ce(port) == 'p' || board_type_ce(port) == 's') &&
+          ports2Pin[port] != PORT_NO_PIN) ||
+         (board_type_ce(port) == 'a' && ports2Pin[port] == PORT_NO_PIN);
+}
+
+constexpr bool board_ports_ok_ce(uint8_t port) {
+  return port >= PORT_COUNT || (board_port_ok_ce(port) && (ports2Mux[port] >> 1) <= 7 &&
+                                board_ports_ok_ce(port + 1));
+}
+
+static_assert(sizeof(ports2Mux) == PORT_COUNT, "ports2Mux needs one entry per port");
+static_assert(board_ports_ok_ce(0),
+              "signature entries must be m/p/s/a with a matching pin and a mux chip of 0-7");
+static_assert(PWM_PORT_COUNT >= 1 && PWM_PORT_COUNT <= 8,
+              "strap_mask and the PWM timer slots assume 1-8 PWM ports");
+
+// ---- Generated tables ----
+
+template <typename> struct BoardPortTable;
+template <uint8_t... I> struct BoardPortTable<Indices<I...>> {
+  static const BoardPort values[sizeof...(I)];
+};
+template <uint8_t... I>
+const BoardPort BoardPortTable<Indices<I...>>::values[sizeof...(I)] PROGMEM = {
+    {board_type_ce(I), ports2Pin[I], board_pwm_index_ce(I), ports2Mux[I]}...};
+
+template <typename> struct BoardPwmTable;
+template <uint8_t... I> struct BoardPwmTable<Indices<I...>> {
+  static const uint8_t values[sizeof...(I)];
+};
+template <uint8_t... I>
+const uint8_t BoardPwmTable<Indices<I...>>::values[sizeof...(I)] PROGMEM = {
+    board_pwm_port_ce(I, 0)...};
+
+template <typename> struct BoardAlwaysOnTable;
+template <uint8_t... I> struct BoardAlwaysOnTable<Indices<I...>> {
+  static const uint8_t values[sizeof...(I)];
+};
+template <uint8_t... I>
+const uint8_t BoardAlwaysOnTable<Indices<I...>>::values[sizeof...(I)] PROGMEM = {
+    board_type_bits_ce('a', I, 0)...};
+
+typedef BoardPortTable<MakeIndices<PORT_COUNT>::type> BoardPorts;
+typedef BoardPwmTable<MakeIndices<PWM_PORT_COUNT>::type> BoardPwmPorts;
+typedef BoardAlwaysOnTable<MakeIndices<PORT_BITS_BYTES>::type> BoardAlwaysOn;
+
+// ---- Lookups ----
+
+inline char board_port_type(uint8_t port) {
+  if (port >= PORT_COUNT)
+    return '\0';
+  return (char)pgm_read_byte(&BoardPorts::values[port].type);
+}
+
+inline uint8_t board_port_pin(uint8_t port) {
+  return pgm_read_byte(&BoardPorts::values[port].pin);
+}
+
+inline uint8_t board_port_mux(uint8_t port) {
+  return pgm_read_byte(&BoardPorts::values[port].mux);
+}
+
+// PWM array index of a port, or -1 when it is not a PWM port.
+inline int8_t board_pwm_index(uint8_t port) {
+  if (port >= PORT_COUNT)
+    return -1;
+  return (int8_t)pgm_read_byte(&BoardPorts::values[port].pwm_index);
+}
+
+// Port driven by a PWM array index, or -1 when out of range.
+inline int8_t board_pwm_port(uint8_t pwm_index) {
+  if (pwm_index >= PWM_PORT_COUNT)
+    return -1;
+  return (int8_t)pgm_read_byte(&BoardPwmPorts::values[pwm_index]);
+}
+
+// Sets the bits of the always-on ports.
+inline void board_set_always_on(PortBits* bits) {
+  for (uint8_t i = 0; i < PORT_BITS_BYTES; i++)
+    bits->b[i] |= pgm_read_byte(&BoardAlwaysOn::values[i]);
+}
@@ -0,0 +1,208 @@
+#include "dew_curve.h"
+
+#include <EEPROM.h>
+
+#include "eeprom_wear.h"
+#include "pwm_out.h"
+
+namespace {
+constexpr uint8_t CURVE_MAGIC = 0xC5;
+
+uint8_t pct_to_duty(uint8_t pct) {
+  return (uint8_t)((pct * 255L) / 100);
+}
+
+uint8_t smoothstep_duty(uint8_t duty_min, uint8_t duty_max, int32_t margin_centi,
+                        int32_t dew_m_on_centi) {
+  if (margin_centi >= dew_m_on_centi)
+    return 0;
+  if (margin_centi <= DEW_M_FULL_CENTI)
+    return duty_max;
+  int32_t num = dew_m_on_centi - margin_centi;
+  int32_t den = dew_m_on_centi - DEW_M_FULL_CENTI;
+  if (den <= 0)
+    return duty_min;
+  int32_t x_q12 = (num << 12) / den;
+  if (x_q12 < 0)
+    x_q12 = 0;
+  if (x_q12 > 4096)
+    x_q12 = 4096;
+  int32_t x2_q12 = (x_q12 * x_q12) >> 12;
+  int32_t term_q12 = (3 << 12) - (2 * x_q12);
+  int32_t smooth_q12 = (x2_q12 * term_q12) >> 12;
+  int32_t duty = duty_min + ((smooth_q12 * (duty_max - duty_min)) >> 12);
+  if (duty < 0)
+    duty = 0;
+  if (duty > 255)
+    duty = 255;
+  return (uint8_t)duty;
+}
+
+uint8_t linear_duty(uint8_t duty_min, uint8_t duty_max, int32_t margin_centi,
+                    int32_t dew_m_on_centi) {
+  if (margin_centi >= dew_m_on_centi)
+    return 0;
+  if (margin_centi <= DEW_M_FULL_CENTI)
+    return duty_max;
+  int32_t den = dew_m_on_centi - DEW_M_FULL_CENTI;
+  if (den <= 0)
+    return duty_min;
+  int32_t num = dew_m_on_centi - margin_centi;
+  return (uint8_t)(duty_min + ((num * (duty_max - duty_min)) / den));
+}
+
+// Piecewise-linear interpolation over breakpoints sorted by margin.
+uint8_t user_duty(const DewCurvePoint* pts, int32_t margin_centi) {
+  if (margin_centi <= pts[0].margin_centi)
+    return pct_to_duty(pts[0].duty_pct);
+  for (uint8_t i = 1; i < DEW_CURVE_POINTS; i++) {
+    if (margin_centi <= pts[i].margin_centi) {
+      int32_t span = pts[i].margin_centi - pts[i - 1].margin_centi;
+      int32_t pct = pts[i - 1].duty_pct;
+      if (span > 0) {
+        pct += ((int32_t)(pts[i].duty_pct - pts[i - 1].duty_pct) *
+                (margin_centi - pts[i - 1].margin_centi)) /
+               span;
+      }
+      return pct_to_duty((uint8_t)pct);
+    }
+  }
+  return pct_to_duty(pts[DEW_CURVE_POINTS - 1].duty_pct);
+}
+
+uint8_t quantize_duty_pct(uint8_t duty) {
+  if (duty == 0)
+    return 0;
+  uint8_t pct = (uint8_t)((duty * 100L + 127) / 255);
+  uint8_t rounded = (uint8_t)(((pct + 2) / 5) * 5);
+  if (rounded > 100)
+    rounded = 100;
+  return (uint8_t)((rounded * 255L + 50) / 100);
+}
+
+// Same 5 % steps for a PWM level.
+uint16_t quantize_level_pct(uint16_t level) {
+  if (level == 0)
+    return 0;
+  uint32_t pct = ((uint32_t)level * 100 + PWM_LEVEL_MAX / 2) / PWM_LEVEL_MAX;
+  uint32_t rounded = ((pct + 2) / 5) * 5;
+  if (rounded > 100)
+    rounded = 100;
+  return (uint16_t)((rounded * PWM_LEVEL_MAX + 50) / 100);
+}
+} // namespace
+
+void dew_curve_defaults(DewCurveSettings* s) {
+  if (!s)
+    return;
+  s->type = DEW_CURVE_SMOOTHSTEP;
+  // Default user curve: linear ramp from full power at 0 C to off at 5 C.
+  for (uint8_t i = 0; i < DEW_CURVE_POINTS; i++) {
+    s->points[i].margin_centi = (int16_t)((500L * i) / (DEW_CURVE_POINTS - 1));
+    s->points[i].duty_pct = (uint8_t)(100 - (100 * i) / (DEW_CURVE_POINTS - 1));
+  }
+}
+
+void dew_curve_load(DewCurveSettings* s) {
+  if (!s)
+    return;
+  if (EEPROM.read(EEPROMCURVEBASE) != CURVE_MAGIC) {
+    dew_curve_defaults(s);
+    return;
+  }
+  EEPROM.get(EEPROMCURVEBASE + 1, *s);
+  if (s->type > DEW_CURVE_USER)
+    dew_curve_defaults(s);
+}
+
+void dew_curve_save(const DewCurveSettings* s) {
+  if (!s)
+    return;
+  eeprom_wear_put(EEPROMCURVEBASE + 1, *s, EE_REGION_CONFIG);
+  eeprom_wear_update(EEPROMCURVEBASE, CURVE_MAGIC, EE_REGION_CONFIG);
+}
+
+void dew_curve_build(DewCurve* c, const DewCurveSettings* s, const DewPortConfig* dew) {
+  if (!c || !s || !dew)
+    return;
+  uint8_t duty_min_pct = dew->duty_min_pct;
+  uint8_t duty_max_pct = dew->duty_max_pct;
+  if (duty_min_pct > duty_max_pct)
+    duty_min_pct = duty_max_pct;
+  uint8_t duty_min = pct_to_duty(duty_min_pct);
+  uint8_t duty_max = pct_to_duty(duty_max_pct);
+
+  // Breakpoints are uploaded one at a time, so sort a copy here.
+  DewCurvePoint pts[DEW_CURVE_POINTS];
+  for (uint8_t i = 0; i < DEW_CURVE_POINTS; i++) {
+    DewCurvePoint p = s->points[i];
+    uint8_t j = i;
+    while (j > 0 && pts[j - 1].margin_centi > p.margin_centi) {
+      pts[j] = pts[j - 1];
+      j--;
+    }
+    pts[j] = p;
+  }
+
+  c->m_on_centi = dew->m_on_centi;
+  c->duty_max = pwm_level_from_8bit(duty_max);
+  c->slew_step = (uint16_t)((dew->slew_pct * (uint32_t)PWM_LEVEL_MAX + 50) / 100);
+  for (uint8_t i = 0; i < DEW_CURVE_ENTRIES; i++) {
+    int32_t margin = (int32_t)i * DEW_CURVE_STEP_CENTI;
+    uint8_t raw = 0;
+    if (margin < c->m_on_centi) {
+      if (s->type == DEW_CURVE_LINEAR) {
+        raw = linear_duty(duty_min, duty_max, margin, c->m_on_centi);
+      } else if (s->type == DEW_CURVE_USER) {
+        raw = user_duty(pts, margin);
+        if (raw > duty_max)
+          raw = duty_max;
+      } else {
+        raw = smoothstep_duty(duty_min, duty_max, margin, c->m_on_centi);
+      }
+    }
+    // Drop to off when below minimum to avoid tiny duty cycles.
+    if (raw < duty_min)
+      raw = 0;
+    c->duty[i] = quantize_duty_pct(raw);
+  }
+}
+
+void dew_curve_build_all(DewCurve* curves, const DewCurveSettings* s, const Config* cfg) {
+  if (!curves || !cfg)
+    return;
+  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+    dew_curve_build(&curves[i], s, &cfg->dew[i]);
+  }
+}
+
+uint16_t dew_curve_lookup(const DewCurve* c, int32_t margin_centi) {
+  if (!c || margin_centi >= c->m_on_centi)
+    return 0;
+  if (margin_centi < 0)
+    return pwm_level_from_8bit(c->duty[0]);
+  int32_t idx = margin_centi / DEW_CURVE_STEP_CENTI;
+  if (idx >= DEW_CURVE_ENTRIES)
+    return 0;
+  return pwm_level_from_8bit(c->duty[idx]);
+}
+
+uint16_t dew_curve_slew(const DewCurve* c, uint16_t* level, uint16_t target, uint32_t dt_ms) {
+  if (!level)
+    return target;
+  // slew_step is per DEW_CONTROL_REF_MS; scale it to the actual interval.
+  uint32_t scaled = c ? ((uint32_t)c->slew_step * dt_ms + DEW_CONTROL_REF_MS / 2) / DEW_CONTROL_REF_MS : 0;
+  uint16_t step = scaled > PWM_LEVEL_MAX ? PWM_LEVEL_MAX : (scaled < 1 ? 1 : (uint16_t)scaled);
+  uint16_t current = *level;
+  if (target > current && target - current > step) {
+    *level = current + step;
+  } else if (current > target && current - target > step) {
+    *level = current - step;
+  } else {
+    *level = target;
+    return target;
+  }
+  // Only the output is rounded, so steps smaller than one 5 % quantum still
+  // add up over several calls.
+  return quantize_level_pct(*level);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "board_config.h"
+#include "eeprom_cfg.h"
+
+#define DEW_CURVE_LINEAR 0
+#define DEW_CURVE_SMOOTHSTEP 1
+#define DEW_CURVE_USER 2
+
+struct DewCurvePoint {
+  int16_t margin_centi;
+  uint8_t duty_pct;
+};
+
+// Curve shape and user breakpoints, persisted at EEPROMCURVEBASE.
+struct DewCurveSettings {
+  uint8_t type;
+  DewCurvePoint points[DEW_CURVE_POINTS];
+};
+
+// Per-port margin-to-duty table rebuilt whenever the dew config or curve
+// changes. Entry i holds the quantized duty (0..255) for margin i * DEW_CURVE_STEP_CENTI;
+// duty_max and slew_step are PWM levels.
+struct DewCurve {
+  int16_t m_on_centi;
+  uint16_t duty_max;
+  uint16_t slew_step;
+  uint8_t duty[DEW_CURVE_ENTRIES];
+};
+
+static_assert(sizeof(DewCurveSettings) == 1 + DEW_CURVE_POINTS * 3,
+              "EEPROMCURVEBASE assumes 3-byte breakpoints");
+static_assert((DEW_CURVE_ENTRIES - 1) * DEW_CURVE_STEP_CENTI >= 500,
+              "Dew curve table must cover the largest K margin");
+
+extern DewCurveSettings g_dew_curve_settings;
+extern DewCurve g_dew_curves[PWM_PORT_COUNT];
+
+void dew_curve_load(DewCurveSettings* s);
+void dew_curve_save(const DewCurveSettings* s);
+void dew_curve_defaults(DewCurveSettings* s);
+void dew_curve_build(DewCurve* c, const DewCurveSettings* s, const DewPortConfig* dew);
+void dew_curve_build_all(DewCurve* curves, const DewCurveSettings* s, const Config* cfg);
+uint16_t dew_curve_lookup(const DewCurve* c, int32_t margin_centi);
+// Moves *level, the unrounded duty, toward target by at most the slew step
+// for dt_ms and returns it rounded to 5 % steps.
+uint16_t dew_curve_slew(const DewCurve* c, uint16_t* level, uint16_t target, uint32_t dt_ms);
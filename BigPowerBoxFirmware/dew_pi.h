@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "board_config.h"
+
+// Fixed-point PI controller that holds a dew strap at a temperature setpoint.
+// The output is a PWM level (0..PWM_LEVEL_MAX). Gains are Q8 levels per
+// centi-degree of error (DEW_PI_KP_Q8, DEW_PI_KI_Q8); the integral gain is per
+// DEW_CONTROL_REF_MS and scaled by the time since the previous update. The
+// integrator is clamped to the duty range and frozen while the output is
+// saturated in the direction of the error, so it cannot wind up during long
+// heat-up or cool-down phases.
+struct DewPi {
+  int32_t integ_q8;
+};
+
+inline void dew_pi_reset(DewPi* pi) {
+  pi->integ_q8 = 0;
+}
+
+inline uint16_t dew_pi_update(DewPi* pi, int32_t setpoint_centi, int32_t measured_centi,
+                              uint16_t duty_max, uint32_t dt_ms) {
+  int32_t err = setpoint_centi - measured_centi;
+  if (err > DEW_PI_ERR_CLAMP_CENTI)
+    err = DEW_PI_ERR_CLAMP_CENTI;
+  if (err < -DEW_PI_ERR_CLAMP_CENTI)
+    err = -DEW_PI_ERR_CLAMP_CENTI;
+  const int32_t max_q8 = (int32_t)duty_max << 8;
+  int32_t p_q8 = err * DEW_PI_KP_Q8;
+  int32_t out_q8 = p_q8 + pi->integ_q8;
+  bool sat_high = out_q8 >= max_q8 && err > 0;
+  bool sat_low = out_q8 <= 0 && err < 0;
+  if (!sat_high && !sat_low) {
+    // Scale in 100 ms units to stay inside int32 for long intervals.
+    pi->integ_q8 += err * DEW_PI_KI_Q8 * (int32_t)(dt_ms / 100) / (DEW_CONTROL_REF_MS / 100);
+    if (pi->integ_q8 > max_q8)
+      pi->integ_q8 = max_q8;
+    if (pi->integ_q8 < 0)
+      pi->integ_q8 = 0;
+    out_q8 = p_q8 + pi->integ_q8;
+  }
+  if (out_q8 <= 0)
+    return 0;
+  if (out_q8 >= max_q8)
+    return duty_max;
+  return (uint16_t)(out_q8 >> 8);
+}
@@ -0,0 +1,108 @@
+#include "dewpoint.h"
+
+#include <avr/pgmspace.h>
+
+#include "indices.h"
+
+namespace {
+// ---- Compile-time math (C++11 constexpr: single-expression recursion) ----
+
+// ln(x) = 2 * atanh(z), z = (x - 1) / (x + 1); converges quickly for x in [1, 2].
+constexpr double ln_series(double z2, double term, uint8_t k) {
+  return k > 25 ? 0.0 : term / (2 * k + 1) + ln_series(z2, term * z2, k + 1);
+}
+
+constexpr double ln_ce(double x) {
+  return 2.0 * ln_series(((x - 1) / (x + 1)) * ((x - 1) / (x + 1)), (x - 1) / (x + 1), 0);
+}
+
+constexpr double MAGNUS_A = 17.62;
+constexpr double MAGNUS_B = 243.12;
+
+// Humidity term: ln(1 + i / 32) in Q16 for the mantissa of a normalized value.
+constexpr uint8_t LN_SEGMENTS = 32;
+constexpr uint16_t ln_entry(uint8_t i) {
+  return (uint16_t)(ln_ce(1.0 + (double)i / LN_SEGMENTS) * 65536.0 + 0.5);
+}
+
+// Temperature term: a * t / (b + t) in Q12, t = -40.96 C + i * 2.56 C.
+constexpr int32_t T_TABLE_MIN_CENTI = -4096;
+constexpr uint8_t T_TABLE_SHIFT = 8;
+constexpr uint8_t T_SEGMENTS = 50;
+constexpr double t_at(uint8_t i) {
+  return (T_TABLE_MIN_CENTI + ((int32_t)i << T_TABLE_SHIFT)) / 100.0;
+}
+constexpr int16_t t_entry(uint8_t i) {
+  return (int16_t)(MAGNUS_A * t_at(i) / (MAGNUS_B + t_at(i)) * 4096.0 +
+                   (t_at(i) < 0 ? -0.5 : 0.5));
+}
+
+template <typename> struct LnTable;
+template <uint8_t... I> struct LnTable<Indices<I...>> {
+  static const uint16_t values[sizeof...(I)];
+};
+template <uint8_t... I>
+const uint16_t LnTable<Indices<I...>>::values[sizeof...(I)] PROGMEM = {ln_entry(I)...};
+
+template <typename> struct TempTable;
+template <uint8_t... I> struct TempTable<Indices<I...>> {
+  static const int16_t values[sizeof...(I)];
+};
+template <uint8_t... I>
+const int16_t TempTable<Indices<I...>>::values[sizeof...(I)] PROGMEM = {t_entry(I)...};
+
+typedef LnTable<MakeIndices<LN_SEGMENTS + 1>::type> Ln;
+// One guard entry past the last segment so t_max can interpolate.
+typedef TempTable<MakeIndices<T_SEGMENTS + 2>::type> Temp;
+
+constexpr int32_t LN2_Q16 = 45426;       // ln(2) * 65536
+constexpr int32_t LN_10000_Q16 = 603609; // ln(10000) * 65536
+constexpr int32_t MAGNUS_A_Q12 = 72172;  // 17.62 * 4096
+constexpr int32_t MAGNUS_B_CENTI = 24312;
+
+// ln(rh_centi / 10000) in Q16 for rh_centi in 100..10000.
+int32_t ln_rh_q16(uint16_t rh_centi) {
+  // Normalize to a Q15 mantissa in [1, 2): v = m * 2^(15 - shift).
+  uint16_t m = rh_centi;
+  uint8_t shift = 0;
+  while ((m & 0x8000u) == 0) {
+    m <<= 1;
+    shift++;
+  }
+  uint16_t frac = m & 0x7FFFu;
+  uint8_t idx = (uint8_t)(frac >> 10);
+  uint16_t rem = frac & 0x03FFu;
+  int32_t lo = pgm_read_word(&Ln::values[idx]);
+  int32_t hi = pgm_read_word(&Ln::values[idx + 1]);
+  int32_t ln_m = lo + (((hi - lo) * rem) >> 10);
+  return ln_m + (int32_t)(15 - shift) * LN2_Q16 - LN_10000_Q16;
+}
+
+// a * t / (b + t) in Q12.
+int32_t temp_term_q12(int32_t t_centi) {
+  int32_t off = t_centi - T_TABLE_MIN_CENTI;
+  uint8_t idx = (uint8_t)(off >> T_TABLE_SHIFT);
+  int32_t rem = off & ((1 << T_TABLE_SHIFT) - 1);
+  int32_t lo = (int16_t)pgm_read_word(&Temp::values[idx]);
+  int32_t hi = (int16_t)pgm_read_word(&Temp::values[idx + 1]);
+  return lo + (((hi - lo) * rem) >> T_TABLE_SHIFT);
+}
+} // namespace
+
+int32_t dewpoint_centi(int32_t t_centi, int32_t rh_centi) {
+  const int32_t t_max = T_TABLE_MIN_CENTI + ((int32_t)T_SEGMENTS << T_TABLE_SHIFT);
+  if (t_centi < T_TABLE_MIN_CENTI)
+    t_centi = T_TABLE_MIN_CENTI;
+  if (t_centi > t_max)
+    t_centi = t_max;
+  if (rh_centi < 100)
+    rh_centi = 100;
+  if (rh_centi > 10000)
+    rh_centi = 10000;
+
+  int32_t gamma_q12 = temp_term_q12(t_centi) + ((ln_rh_q16((uint16_t)rh_centi) + 8) >> 4);
+  int32_t num = MAGNUS_B_CENTI * gamma_q12;
+  int32_t den = MAGNUS_A_Q12 - gamma_q12;
+  // Round to nearest rather than toward zero.
+  return (num + (num >= 0 ? den / 2 : -den / 2)) / den;
+}
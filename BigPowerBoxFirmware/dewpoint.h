@@ -0,0 +1,17 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Dew point from temperature and relative humidity using the Magnus formula
+// (a = 17.62, b = 243.12 C), evaluated in fixed point from two
+// compile-time tables: ln(x) for the humidity term and a*t/(b+t) for the
+// temperature term, each with linear interpolation.
+//
+// Inputs are clamped to -40.96..87.04 C and 1..100 %RH. Compared against the
+// float logf() formula over that whole range, the worst-case error is 0.025 C
+// (0.021 C below 50 C), well under probe accuracy.
+int32_t dewpoint_centi(int32_t t_centi, int32_t rh_centi);
+
+inline int32_t dew_margin_centi(int32_t t_centi, int32_t rh_centi) {
+  return t_centi - dewpoint_centi(t_centi, rh_centi);
+}
@@ -1,70 +1,338 @@
 #include "eeprom_cfg.h"
 
 #include <EEPROM.h>
-#include <stdio.h>
 #include <string.h>
+#include <util/crc16.h>
 
+#include "eeprom_wear.h"
+#include "eventlog.h"
 #include "ports.h"
+#include "pwm_out.h"
+#include "timing.h"
 
 namespace {
+// A record is this header followed by `length` bytes of Config. The CRC
+// covers version, length, seq and the payload.
+struct RecordHeader {
+  uint8_t magic;
+  uint8_t version;
+  uint8_t length;
+  // Incremented per write; the valid record with the newest seq is current.
+  uint16_t seq;
+  uint16_t crc;
+};
+
+constexpr uint8_t SLOT_COUNT = (EEPROMCONFEND - EEPROMCONFBASE) / CONFIG_SLOT_SIZE;
+// Firmware with fixed name slots started the config slots at
+// LEGACY_CONFBASE, and before profiles the slots ran up to the dew curve.
+// Every slot position used by either is scanned at boot; a record found
+// outside the ring is loaded once and moved into it.
+constexpr int LEGACY_CONFBASE = EEPROMNAMEBASE + PORT_COUNT * NAMELENGTH;
+constexpr uint8_t SCAN_SLOT_COUNT = (EEPROMCURVEBASE - LEGACY_CONFBASE) / CONFIG_SLOT_SIZE;
+constexpr uint8_t SCAN_RING_START = (EEPROMCONFBASE - LEGACY_CONFBASE) / CONFIG_SLOT_SIZE;
+constexpr uint8_t PAYLOAD_MAX = CONFIG_SLOT_SIZE - sizeof(RecordHeader);
+// Schema 1 is the unversioned layout: the LEGACY_CONFIG_FLAG byte followed
+// by the schema 2 fields.
+constexpr uint8_t V1_LENGTH = sizeof(Config) + 1;
+
+// Schema 0 is the record of the first release: BASELINE_CONFIG_FLAG and a
+// fixed layout with 8-bit PWM levels and one set of dew settings, stored
+// back to back from byte 224 up to the end of EEPROM.
+constexpr uint8_t BASELINE_PWM_PORTS = 4;
+struct BaselineConfig {
+  uint8_t flag;
+  uint16_t portStatus;
+  uint8_t pwmPorts[BASELINE_PWM_PORTS];
+  uint8_t pwmPortMode[BASELINE_PWM_PORTS];
+  int16_t dew_m_on_centi;
+  uint8_t dew_duty_min_pct;
+  uint8_t dew_duty_max_pct;
+};
+constexpr int BASELINE_CONFBASE = 224;
+constexpr uint8_t V0_LENGTH = sizeof(BaselineConfig);
+
+static_assert(V0_LENGTH == 15, "schema 0 records are 15 bytes");
+static_assert(sizeof(Config) <= PAYLOAD_MAX, "Config outgrew CONFIG_SLOT_SIZE");
+static_assert(V1_LENGTH <= PAYLOAD_MAX, "schema 1 records must fit the migration buffer");
+static_assert(SLOT_COUNT >= 2, "a torn write must leave the previous record intact");
+static_assert((EEPROMCONFBASE - LEGACY_CONFBASE) % CONFIG_SLOT_SIZE == 0,
+              "the name region must keep older config slots aligned");
+
+// A profile slot is PROFILE_MAGIC, the Profile and a CRC-16 of the Profile.
+static_assert(1 + sizeof(Profile) + 2 <= PROFILE_SLOT_SIZE, "Profile outgrew PROFILE_SLOT_SIZE");
+
+// MIGRATIONS[v] turns a schema v payload into schema v + 1 in place and
+// returns the new length. Fields appended at the end of Config need no step:
+// a shorter record is loaded over the defaults. Anything else that changes
+// the layout needs CONFIG_VERSION bumped and a step added here.
+typedef uint8_t (*MigrationStep)(uint8_t* buf, uint8_t len);
+
+uint8_t migrate_v0_to_v1(uint8_t* buf, uint8_t len) {
+  // Always V0_LENGTH: the baseline record has a fixed size.
+  (void)len;
+  BaselineConfig old;
+  memcpy(&old, buf, sizeof(old));
+  Config cfg;
+  eeprom_cfg_defaults(&cfg);
+  for (uint8_t i = 0; i < PORT_COUNT && i < 16; i++)
+    port_bits_set(&cfg.portStatus, i, (old.portStatus >> i) & 1);
+  for (uint8_t i = 0; i < PWM_PORT_COUNT && i < BASELINE_PWM_PORTS; i++) {
+    cfg.pwmPorts[i] = pwm_level_from_8bit(old.pwmPorts[i]);
+    cfg.pwmPortMode[i] = old.pwmPortMode[i];
+  }
+  // The single set of dew settings applied to every port.
+  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+    cfg.dew[i].m_on_centi = old.dew_m_on_centi;
+    cfg.dew[i].duty_min_pct = old.dew_duty_min_pct;
+    cfg.dew[i].duty_max_pct = old.dew_duty_max_pct;
+  }
+  buf[0] = LEGACY_CONFIG_FLAG;
+  memcpy(buf + 1, &cfg, sizeof(cfg));
+  return V1_LENGTH;
+}
+
+uint8_t migrate_v1_to_v2(uint8_t* buf, uint8_t len) {
+  // Drop the flag byte.
+  memmove(buf, buf + 1, len - 1);
+  return len - 1;
+}
+
+const MigrationStep MIGRATIONS[] = {migrate_v0_to_v1, migrate_v1_to_v2};
+static_assert(sizeof(MIGRATIONS) / sizeof(MIGRATIONS[0]) == CONFIG_VERSION,
+              "every schema version needs a migration step");
+
+// Slot holding the current record, its sequence number and whether there is
+// one; found once by eeprom_cfg_init.
+uint8_t s_slot = SLOT_COUNT - 1;
+uint16_t s_seq = 0;
+bool s_have_record = false;
+// eeprom_cfg_load found stored fields out of range.
+bool s_load_invalid = false;
+// Config waiting to be written, and when it was first and last scheduled.
+const Config* s_pending = nullptr;
+unsigned long s_first_ms = 0;
+unsigned long s_last_ms = 0;
+
 bool cfg_differs(const Config& a, const Config& b) {
-  if (a.portStatus != b.portStatus)
+  if (!port_bits_equal(&a.portStatus, &b.portStatus))
     return true;
   for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
     if (a.pwmPorts[i] != b.pwmPorts[i])
       return true;
     if (a.pwmPortMode[i] != b.pwmPortMode[i])
       return true;
+    if (a.ramp_pct_s[i] != b.ramp_pct_s[i])
+      return true;
   }
-  if (a.dew_m_on_centi != b.dew_m_on_centi)
-    return true;
-  if (a.dew_duty_min_pct != b.dew_duty_min_pct)
+  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+    const DewPortConfig& da = a.dew[i];
+    const DewPortConfig& db = b.dew[i];
+    if (da.m_on_centi != db.m_on_centi || da.duty_min_pct != db.duty_min_pct ||
+        da.duty_max_pct != db.duty_max_pct || da.slew_pct != db.slew_pct)
+      return true;
+  }
+  if (a.sample_min_ms != b.sample_min_ms || a.sample_max_ms != b.sample_max_ms)
     return true;
-  if (a.dew_duty_max_auto_pct != b.dew_duty_max_auto_pct)
+  if (a.ambient_fusion != b.ambient_fusion || a.ambient_primary != b.ambient_primary)
     return true;
   return false;
 }
+
+int slot_addr(uint8_t slot) {
+  return EEPROMCONFBASE + (int)slot * CONFIG_SLOT_SIZE;
+}
+
+uint16_t header_crc(const RecordHeader& h) {
+  uint16_t crc = 0xFFFF;
+  crc = _crc_ccitt_update(crc, h.version);
+  crc = _crc_ccitt_update(crc, h.length);
+  crc = _crc_ccitt_update(crc, (uint8_t)(h.seq & 0xFF));
+  crc = _crc_ccitt_update(crc, (uint8_t)(h.seq >> 8));
+  return crc;
+}
+
+int scan_addr(uint8_t index) {
+  return LEGACY_CONFBASE + (int)index * CONFIG_SLOT_SIZE;
+}
+
+// Reads a record header; true when it starts an intact record of a schema
+// this firmware can load.
+bool read_header(int addr, RecordHeader* h) {
+  EEPROM.get(addr, *h);
+  if (h->magic != CONFIG_RECORD_MAGIC || h->version == 0 || h->version > CONFIG_VERSION ||
+      h->length > PAYLOAD_MAX)
+    return false;
+  uint16_t crc = header_crc(*h);
+  addr += sizeof(RecordHeader);
+  for (uint8_t i = 0; i < h->length; i++)
+    crc = _crc_ccitt_update(crc, EEPROM.read(addr + i));
+  return crc == h->crc;
+}
+
+int profile_addr(uint8_t slot) {
+  return EEPROMPROFILEBASE + (int)slot * PROFILE_SLOT_SIZE;
+}
+
+uint16_t profile_crc(const Profile& p) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&p);
+  uint16_t crc = 0xFFFF;
+  for (uint8_t i = 0; i < sizeof(Profile); i++)
+    crc = _crc_ccitt_update(crc, bytes[i]);
+  return crc;
+}
+
+// Runs a payload of the given schema through the migration steps and loads
+// it over the defaults already in *cfg.
+void load_payload(Config* cfg, uint8_t* buf, uint8_t version, uint8_t len) {
+  while (version < CONFIG_VERSION) {
+    len = MIGRATIONS[version](buf, len);
+    version++;
+  }
+  memcpy(cfg, buf, len < sizeof(Config) ? len : sizeof(Config));
+}
+
+// Finds the last unversioned record of the given flag and stride from base
+// up to end, as the old firmware did.
+bool find_legacy(uint8_t flag, uint8_t stride, int base, int end, int* found_addr) {
+  bool found = false;
+  for (int addr = base; addr + stride <= end; addr += stride) {
+    if (EEPROM.read(addr) == flag) {
+      *found_addr = addr;
+      found = true;
+    }
+  }
+  return found;
+}
+
+void write_record(const Config* cfg) {
+  if (s_have_record) {
+    RecordHeader h;
+    EEPROM.get(slot_addr(s_slot), h);
+    if (h.version == CONFIG_VERSION && h.length == sizeof(Config)) {
+      Config saved;
+      EEPROM.get(slot_addr(s_slot) + (int)sizeof(RecordHeader), saved);
+      if (!cfg_differs(*cfg, saved))
+        return;
+    }
+  }
+
+  RecordHeader h;
+  h.magic = CONFIG_RECORD_MAGIC;
+  h.version = CONFIG_VERSION;
+  h.length = sizeof(Config);
+  h.seq = (uint16_t)(s_seq + 1);
+  uint16_t crc = header_crc(h);
+  const uint8_t* p = (const uint8_t*)cfg;
+  for (uint8_t i = 0; i < sizeof(Config); i++)
+    crc = _crc_ccitt_update(crc, p[i]);
+  h.crc = crc;
+
+  // The previous record stays valid until this one is complete.
+  uint8_t next = (uint8_t)((s_slot + 1) % SLOT_COUNT);
+  eeprom_wear_put(slot_addr(next) + (int)sizeof(RecordHeader), *cfg, EE_REGION_CONFIG);
+  eeprom_wear_put(slot_addr(next), h, EE_REGION_CONFIG);
+  s_slot = next;
+  s_seq = h.seq;
+  s_have_record = true;
+}
+
+void write_pending() {
+  if (!s_pending)
+    return;
+  TimingScope timing(TIME_CONFIG_WRITE);
+  write_record(s_pending);
+  s_pending = nullptr;
+}
 } // namespace
 
+void eeprom_cfg_dew_defaults(DewPortConfig* dew) {
+  if (!dew)
+    return;
+  dew->m_on_centi = DEW_M_ON_CENTI;
+  dew->duty_min_pct = DEW_DUTY_MIN_PCT;
+  dew->duty_max_pct = DEW_DUTY_MAX_AUTO_PCT;
+  dew->slew_pct = DEW_DUTY_SLEW_STEP_PCT;
+}
+
 void eeprom_cfg_defaults(Config* cfg) {
   if (!cfg)
     return;
-  cfg->currentData = CURRENTCONFIGFLAG;
-  cfg->portStatus = 0;
+  port_bits_clear(&cfg->portStatus);
   for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
     cfg->pwmPorts[i] = 0;
     cfg->pwmPortMode[i] = PWM_MODE_VARIABLE;
+    cfg->ramp_pct_s[i] = PWM_RAMP_DEFAULT_PCT_S;
+    eeprom_cfg_dew_defaults(&cfg->dew[i]);
   }
-  cfg->dew_m_on_centi = DEW_M_ON_CENTI;
-  cfg->dew_duty_min_pct = DEW_DUTY_MIN_PCT;
-  cfg->dew_duty_max_auto_pct = DEW_DUTY_MAX_AUTO_PCT;
+  cfg->sample_min_ms = SENSOR_INTERVAL_MIN_MS;
+  cfg->sample_max_ms = SENSOR_INTERVAL_MAX_MS;
+  cfg->ambient_fusion = FUSION_PRIMARY;
+  cfg->ambient_primary = 0;
 }
 
-void eeprom_cfg_init(Config* cfg) {
+void eeprom_cfg_load(Config* cfg) {
   if (!cfg)
     return;
   eeprom_cfg_defaults(cfg);
 
-  int addr = EEPROMCONFBASE;
-  Config tmp;
   bool found = false;
   bool corrected = false;
-  while (addr + (int)sizeof(Config) <= EEPROM.length()) {
-    EEPROM.get(addr, tmp);
-    if (tmp.currentData == CURRENTCONFIGFLAG) {
-      *cfg = tmp;
+  // Set when stored fields were out of range, as opposed to normalization.
+  bool invalid = false;
+  RecordHeader best = {};
+  uint8_t best_index = 0;
+  for (uint8_t i = 0; i < SCAN_SLOT_COUNT; i++) {
+    RecordHeader h;
+    if (!read_header(scan_addr(i), &h))
+      continue;
+    if (!s_have_record || (int16_t)(h.seq - best.seq) > 0) {
+      best = h;
+      best_index = i;
+      s_have_record = true;
+    }
+  }
+
+  uint8_t buf[PAYLOAD_MAX];
+  if (s_have_record) {
+    s_seq = best.seq;
+    int addr = scan_addr(best_index) + (int)sizeof(RecordHeader);
+    for (uint8_t i = 0; i < best.length; i++)
+      buf[i] = EEPROM.read(addr + i);
+    load_payload(cfg, buf, best.version, best.length);
+    found = true;
+    // Store migrated records in the current schema.
+    corrected = best.version != CONFIG_VERSION;
+    if (best_index >= SCAN_RING_START && best_index - SCAN_RING_START < SLOT_COUNT) {
+      s_slot = best_index - SCAN_RING_START;
+    } else {
+      s_slot = SLOT_COUNT - 1;
+      corrected = true;
+    }
+  } else {
+    int addr = 0;
+    if (find_legacy(LEGACY_CONFIG_FLAG, V1_LENGTH, LEGACY_CONFBASE, EEPROMCURVEBASE, &addr)) {
+      for (uint8_t i = 0; i < V1_LENGTH; i++)
+        buf[i] = EEPROM.read(addr + i);
+      load_payload(cfg, buf, 1, V1_LENGTH);
+      found = true;
+      corrected = true;
+    } else if (find_legacy(BASELINE_CONFIG_FLAG, V0_LENGTH, BASELINE_CONFBASE, EEPROMSIZE,
+                           &addr)) {
+      for (uint8_t i = 0; i < V0_LENGTH; i++)
+        buf[i] = EEPROM.read(addr + i);
+      load_payload(cfg, buf, 0, V0_LENGTH);
       found = true;
+      corrected = true;
     }
-    addr += sizeof(Config);
   }
 
   if (found) {
     // Guard against stale EEPROM data from older firmware revisions.
     bool invalid_pwm_mode = false;
     for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
-      if (cfg->pwmPortMode[i] != PWM_MODE_VARIABLE &&
-          cfg->pwmPortMode[i] != PWM_MODE_SWITCHABLE &&
-          cfg->pwmPortMode[i] != PWM_MODE_DEW_AMBIENT) {
+      if ((cfg->pwmPortMode[i] != PWM_MODE_VARIABLE &&
+           cfg->pwmPortMode[i] != PWM_MODE_SWITCHABLE && !ports_is_dew_mode(cfg->pwmPortMode[i])) ||
+          cfg->pwmPorts[i] > PWM_LEVEL_MAX || cfg->ramp_pct_s[i] > 100) {
         invalid_pwm_mode = true;
         break;
       }
@@ -72,107 +340,106 @@ void eeprom_cfg_init(Config* cfg) {
     if (invalid_pwm_mode) {
       eeprom_cfg_defaults(cfg);
       corrected = true;
+      invalid = true;
     }
-    uint16_t valid_mask = (PORT_COUNT >= 16) ? 0xFFFFu : (uint16_t)((1u << PORT_COUNT) - 1u);
-    uint16_t masked = cfg->portStatus & valid_mask;
-    if (masked != cfg->portStatus) {
-      cfg->portStatus = masked;
+    if (port_bits_trim(&cfg->portStatus)) {
       corrected = true;
+      invalid = true;
     }
-    for (uint8_t i = 0; i < PORT_COUNT; i++) {
-      if (ports_port_type(i) == 'a') {
-        uint16_t bit = (uint16_t)(1u << i);
-        if ((cfg->portStatus & bit) == 0) {
-          cfg->portStatus |= bit;
-          corrected = true;
-        }
-      }
-    }
-    if (cfg->dew_m_on_centi < 0 || cfg->dew_m_on_centi > 500) {
-      cfg->dew_m_on_centi = DEW_M_ON_CENTI;
+    PortBits with_always_on = cfg->portStatus;
+    board_set_always_on(&with_always_on);
+    if (!port_bits_equal(&with_always_on, &cfg->portStatus)) {
+      cfg->portStatus = with_always_on;
       corrected = true;
     }
-    if (cfg->dew_duty_min_pct > 100 || cfg->dew_duty_max_auto_pct > 100) {
-      cfg->dew_duty_min_pct = DEW_DUTY_MIN_PCT;
-      cfg->dew_duty_max_auto_pct = DEW_DUTY_MAX_AUTO_PCT;
+    for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+      DewPortConfig* dew = &cfg->dew[i];
+      if (dew->m_on_centi < 0 || dew->m_on_centi > 500 || dew->duty_min_pct > 100 ||
+          dew->duty_max_pct > 100 || dew->duty_min_pct > dew->duty_max_pct ||
+          dew->slew_pct == 0 || dew->slew_pct > 100) {
+        eeprom_cfg_dew_defaults(dew);
+        corrected = true;
+        invalid = true;
+      }
+    }
+    if (cfg->sample_min_ms < SENSOR_INTERVAL_FLOOR_MS || cfg->sample_max_ms > SENSOR_INTERVAL_CEIL_MS ||
+        cfg->sample_min_ms > cfg->sample_max_ms) {
+      cfg->sample_min_ms = SENSOR_INTERVAL_MIN_MS;
+      cfg->sample_max_ms = SENSOR_INTERVAL_MAX_MS;
       corrected = true;
+      invalid = true;
     }
-    if (cfg->dew_duty_min_pct > cfg->dew_duty_max_auto_pct) {
-      cfg->dew_duty_min_pct = DEW_DUTY_MIN_PCT;
-      cfg->dew_duty_max_auto_pct = DEW_DUTY_MAX_AUTO_PCT;
+    if (cfg->ambient_fusion > FUSION_AVERAGE || cfg->ambient_primary > 0x7F) {
+      cfg->ambient_fusion = FUSION_PRIMARY;
+      cfg->ambient_primary = 0;
       corrected = true;
+      invalid = true;
     }
   }
 
-  if (!found || corrected) {
+  s_load_invalid = invalid;
+  if (!found || corrected)
     eeprom_cfg_save(cfg);
-  }
 }
 
-void eeprom_name_init_defaults() {
-  char buf[NAMELENGTH];
-  for (uint8_t i = 0; i < PORT_COUNT; i++) {
-    int addr = EEPROMNAMEBASE + (i * NAMELENGTH);
-    EEPROM.get(addr, buf);
-    bool uninitialized = true;
-    for (uint8_t j = 0; j < NAMELENGTH; j++) {
-      if ((uint8_t)buf[j] != 0xFF) {
-        uninitialized = false;
-        break;
-      }
-    }
-    if (uninitialized) {
-      char name[NAMELENGTH];
-      snprintf(name, sizeof(name), "Port%02u", (unsigned)i);
-      eeprom_name_write(i, name);
-    }
-  }
+void eeprom_cfg_init() {
+  if (s_load_invalid)
+    eventlog_record(EVENT_CONFIG_CORRECTED, 0);
+  eeprom_cfg_flush();
 }
 
 void eeprom_cfg_save(const Config* cfg) {
   if (!cfg)
     return;
-  Config saved;
-  int addr = EEPROMCONFBASE;
-  int last_addr = EEPROMCONFBASE;
-  while (addr + (int)sizeof(Config) <= EEPROM.length()) {
-    EEPROM.get(addr, saved);
-    if (saved.currentData == CURRENTCONFIGFLAG) {
-      last_addr = addr;
-    }
-    addr += sizeof(Config);
-  }
+  unsigned long now = millis();
+  if (!s_pending)
+    s_first_ms = now;
+  s_pending = cfg;
+  s_last_ms = now;
+}
 
-  EEPROM.get(last_addr, saved);
-  if (!cfg_differs(*cfg, saved))
+void eeprom_cfg_flush() {
+  write_pending();
+  eeprom_wear_flush();
+}
+
+void eeprom_cfg_update(unsigned long now) {
+  if (!s_pending)
     return;
+  // Write-behind saves leave the counters to eeprom_wear_put so the counter
+  // block is not rewritten on every config change.
+  if ((now - s_last_ms) >= CONFIG_SAVE_QUIET_MS || (now - s_first_ms) >= CONFIG_SAVE_MAX_DELAY_MS)
+    write_pending();
+}
 
-  EEPROM.write(last_addr, OLDCONFIGFLAG);
-  int next_addr = last_addr + sizeof(Config);
-  if (next_addr + (int)sizeof(Config) > EEPROM.length()) {
-    next_addr = EEPROMCONFBASE;
-  }
-  EEPROM.put(next_addr, *cfg);
+bool eeprom_profile_read(uint8_t slot, Profile* out) {
+  if (!out || slot >= PROFILE_COUNT)
+    return false;
+  int addr = profile_addr(slot);
+  if (EEPROM.read(addr) != PROFILE_MAGIC)
+    return false;
+  uint16_t crc;
+  EEPROM.get(addr + 1, *out);
+  EEPROM.get(addr + 1 + (int)sizeof(Profile), crc);
+  if (crc != profile_crc(*out))
+    return false;
+  out->name[PROFILE_NAME_LENGTH - 1] = '\0';
+  return true;
 }
 
-void eeprom_name_read(uint8_t port, char* out) {
-  if (!out)
+void eeprom_profile_write(uint8_t slot, const Profile* profile) {
+  if (!profile || slot >= PROFILE_COUNT)
     return;
-  int addr = EEPROMNAMEBASE + (port * NAMELENGTH);
-  EEPROM.get(addr, out);
-  out[NAMELENGTH - 1] = '\0';
+  // Only bytes that changed are rewritten, so saving the same profile twice
+  // costs no wear.
+  int addr = profile_addr(slot);
+  eeprom_wear_put(addr + 1, *profile, EE_REGION_PROFILES);
+  eeprom_wear_put(addr + 1 + (int)sizeof(Profile), profile_crc(*profile), EE_REGION_PROFILES);
+  eeprom_wear_update(addr, PROFILE_MAGIC, EE_REGION_PROFILES);
 }
 
-void eeprom_name_write(uint8_t port, const char* name) {
-  if (!name)
-    return;
-  char buf[NAMELENGTH];
-  char old[NAMELENGTH];
-  int addr = EEPROMNAMEBASE + (port * NAMELENGTH);
-  EEPROM.get(addr, old);
-  strncpy(buf, name, NAMELENGTH);
-  buf[NAMELENGTH - 1] = '\0';
-  if (strcmp(old, buf) == 0)
+void eeprom_profile_erase(uint8_t slot) {
+  if (slot >= PROFILE_COUNT)
     return;
-  EEPROM.put(addr, buf);
+  eeprom_wear_update(profile_addr(slot), 0xFF, EE_REGION_PROFILES);
 }
@@ -3,22 +3,60 @@
 #include <Arduino.h>
 
 #include "board_config.h"
+#include "port_bits.h"
 
+// Ambient dew control settings for one PWM port.
+struct DewPortConfig {
+  int16_t m_on_centi;
+  uint8_t duty_min_pct;
+  uint8_t duty_max_pct;
+  uint8_t slew_pct;
+};
+
+// Stored as a versioned record; see CONFIG_VERSION before changing the layout.
 struct Config {
-  uint8_t currentData;
-  uint16_t portStatus;
-  uint8_t pwmPorts[PWM_PORT_COUNT];
+  PortBits portStatus;
+  uint16_t pwmPorts[PWM_PORT_COUNT];
   uint8_t pwmPortMode[PWM_PORT_COUNT];
-  int16_t dew_m_on_centi;
-  uint8_t dew_duty_min_pct;
-  uint8_t dew_duty_max_auto_pct;
+  DewPortConfig dew[PWM_PORT_COUNT];
+  // Soft-start ramp rate per PWM port, percent of full scale per second.
+  uint8_t ramp_pct_s[PWM_PORT_COUNT];
+  // Adaptive sensor interval bounds.
+  uint16_t sample_min_ms;
+  uint16_t sample_max_ms;
+  // Ambient probe fusion mode and preferred probe address (0 = first found).
+  uint8_t ambient_fusion;
+  uint8_t ambient_primary;
 };
 
 extern Config g_config;
 
-void eeprom_cfg_init(Config* cfg);
+// A named snapshot of the output side of Config, stored in its own slot.
+struct Profile {
+  char name[PROFILE_NAME_LENGTH];
+  PortBits portStatus;
+  uint16_t pwmPorts[PWM_PORT_COUNT];
+  uint8_t pwmPortMode[PWM_PORT_COUNT];
+  DewPortConfig dew[PWM_PORT_COUNT];
+};
+
+// Loads the stored config, migrating older schemas. Call before anything
+// writes EEPROM: records of the first release may sit in any region.
+void eeprom_cfg_load(Config* cfg);
+// Logs and writes back a config that eeprom_cfg_load corrected or migrated.
+// Call once the wear counters and the event log are up.
+void eeprom_cfg_init();
+// Schedules *cfg to be written; the write happens in eeprom_cfg_update once
+// changes have settled, or in eeprom_cfg_flush. *cfg must stay valid.
 void eeprom_cfg_save(const Config* cfg);
+// Writes a scheduled config and any unsaved wear counts now. Call before
+// anything that may cost power.
+void eeprom_cfg_flush();
+// Call every loop iteration.
+void eeprom_cfg_update(unsigned long now);
 void eeprom_cfg_defaults(Config* cfg);
-void eeprom_name_init_defaults();
-void eeprom_name_read(uint8_t port, char* out);
-void eeprom_name_write(uint8_t port, const char* name);
+void eeprom_cfg_dew_defaults(DewPortConfig* dew);
+// Returns false for an empty slot or a record that fails its CRC.
+bool eeprom_profile_read(uint8_t slot, Profile* out);
+void eeprom_profile_write(uint8_t slot, const Profile* profile);
+void eeprom_profile_erase(uint8_t slot);
@@ -0,0 +1,163 @@
+#include "eeprom_names.h"
+
+#include <EEPROM.h>
+#include <stdio.h>
+#include <string.h>
+#include <util/crc16.h>
+
+#include "eeprom_wear.h"
+
+// The name region is a pool of records, one live record per port. A new
+// name goes to the next free record and only then retires the old one, so a
+// port renamed over and over spreads its writes over every spare record and
+// a torn write leaves the previous name in place.
+
+namespace {
+constexpr uint8_t NAME_CHARS = NAMELENGTH - 1;
+// Record tag: NAME_TAG | port. Retired records are tagged 0.
+constexpr uint8_t NAME_TAG = 0x80;
+constexpr uint8_t NO_RECORD = 0xFF;
+constexpr uint8_t RECORD_COUNT = EEPROMNAMESIZE / NAME_RECORD_SIZE;
+
+struct NameRecord {
+  uint8_t tag;
+  char name[NAME_CHARS];
+  uint16_t crc;
+};
+
+static_assert(sizeof(NameRecord) == NAME_RECORD_SIZE, "NAME_RECORD_SIZE must match NameRecord");
+static_assert(PORT_COUNT < NAME_TAG, "port numbers must fit the record tag");
+static_assert(RECORD_COUNT > PORT_COUNT, "the name region needs a spare record");
+static_assert(RECORD_COUNT < NO_RECORD, "record indices must fit a byte");
+static_assert(NAME_RECORD_SIZE >= NAMELENGTH, "importing old names in place needs records as "
+                                              "large as the old slots");
+
+// Record holding each port's name, and where the search for a free record
+// starts.
+uint8_t s_record[PORT_COUNT];
+uint8_t s_cursor = 0;
+
+int record_addr(uint8_t index) {
+  return EEPROMNAMEBASE + (int)index * NAME_RECORD_SIZE;
+}
+
+uint16_t record_crc(const NameRecord& r) {
+  uint16_t crc = _crc_ccitt_update(0xFFFF, r.tag);
+  for (uint8_t i = 0; i < NAME_CHARS; i++)
+    crc = _crc_ccitt_update(crc, (uint8_t)r.name[i]);
+  return crc;
+}
+
+// Returns the port the record belongs to, or NO_RECORD.
+uint8_t read_record(uint8_t index, NameRecord* r) {
+  EEPROM.get(record_addr(index), *r);
+  if (!(r->tag & NAME_TAG) || (r->tag & ~NAME_TAG) >= PORT_COUNT || r->crc != record_crc(*r))
+    return NO_RECORD;
+  return r->tag & ~NAME_TAG;
+}
+
+void make_record(NameRecord* r, uint8_t port, const char* name) {
+  memset(r, 0, sizeof(*r));
+  r->tag = NAME_TAG | port;
+  strncpy(r->name, name, NAME_CHARS);
+  r->crc = record_crc(*r);
+}
+
+void default_name(uint8_t port, char* out) {
+  snprintf(out, NAMELENGTH, "Port%02u", (unsigned)port);
+}
+
+bool record_in_use(uint8_t index) {
+  for (uint8_t i = 0; i < PORT_COUNT; i++) {
+    if (s_record[i] == index)
+      return true;
+  }
+  return false;
+}
+
+void store_record(uint8_t port, const NameRecord& r) {
+  uint8_t index = s_cursor;
+  while (record_in_use(index))
+    index = (uint8_t)((index + 1) % RECORD_COUNT);
+  eeprom_wear_put(record_addr(index), r, EE_REGION_NAMES);
+  uint8_t old = s_record[port];
+  s_record[port] = index;
+  s_cursor = (uint8_t)((index + 1) % RECORD_COUNT);
+  if (old != NO_RECORD)
+    eeprom_wear_update(record_addr(old), 0, EE_REGION_NAMES);
+}
+
+// Firmware before name records kept NAMELENGTH-byte slots from
+// EEPROMNAMEBASE. Record p never reaches below old slot p, so converting
+// from the last port down reads every old slot before it is overwritten.
+void import_fixed_slots() {
+  for (uint8_t port = PORT_COUNT; port-- > 0;) {
+    char name[NAMELENGTH];
+    bool blank = true;
+    for (uint8_t i = 0; i < NAMELENGTH; i++) {
+      name[i] = (char)EEPROM.read(EEPROMNAMEBASE + port * NAMELENGTH + i);
+      if ((uint8_t)name[i] != 0xFF)
+        blank = false;
+    }
+    name[NAMELENGTH - 1] = '\0';
+    if (blank)
+      default_name(port, name);
+    NameRecord r;
+    make_record(&r, port, name);
+    eeprom_wear_put(record_addr(port), r, EE_REGION_NAMES);
+    s_record[port] = port;
+  }
+  s_cursor = PORT_COUNT;
+}
+} // namespace
+
+void eeprom_name_init() {
+  bool found = false;
+  memset(s_record, NO_RECORD, sizeof(s_record));
+  for (uint8_t i = 0; i < RECORD_COUNT; i++) {
+    NameRecord r;
+    uint8_t port = read_record(i, &r);
+    // A torn rename can leave two records for a port; either name is fine.
+    if (port != NO_RECORD && s_record[port] == NO_RECORD) {
+      s_record[port] = i;
+      found = true;
+    }
+  }
+  if (!found)
+    import_fixed_slots();
+  for (uint8_t port = 0; port < PORT_COUNT; port++) {
+    if (s_record[port] != NO_RECORD)
+      continue;
+    char name[NAMELENGTH];
+    default_name(port, name);
+    eeprom_name_write(port, name);
+  }
+}
+
+void eeprom_name_read(uint8_t port, char* out) {
+  if (!out)
+    return;
+  out[0] = '\0';
+  if (port >= PORT_COUNT)
+    return;
+  NameRecord r;
+  if (s_record[port] == NO_RECORD || read_record(s_record[port], &r) != port) {
+    default_name(port, out);
+    return;
+  }
+  memcpy(out, r.name, NAME_CHARS);
+  out[NAME_CHARS] = '\0';
+}
+
+void eeprom_name_write(uint8_t port, const char* name) {
+  if (!name || port >= PORT_COUNT)
+    return;
+  NameRecord r;
+  make_record(&r, port, name);
+  if (s_record[port] != NO_RECORD) {
+    NameRecord old;
+    if (read_record(s_record[port], &old) == port && memcmp(&old, &r, sizeof(r)) == 0)
+      return;
+  }
+  store_record(port, r);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "board_config.h"
+
+// Finds the name records, importing names stored in the old fixed slots and
+// giving unnamed ports a default name.
+void eeprom_name_init();
+// out must hold NAMELENGTH bytes.
+void eeprom_name_read(uint8_t port, char* out);
+// Does nothing when the name is unchanged.
+void eeprom_name_write(uint8_t port, const char* name);
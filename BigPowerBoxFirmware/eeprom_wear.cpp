@@ -0,0 +1,101 @@
+#include "eeprom_wear.h"
+
+#include <EEPROM.h>
+#include <string.h>
+#include <util/crc16.h>
+
+namespace {
+// Stored at EEPROMWEARBASE; the CRC covers the counts.
+struct WearBlock {
+  uint16_t crc;
+  uint32_t writes[EE_REGION_COUNT];
+};
+
+static_assert(sizeof(WearBlock) == EEPROMWEARSIZE, "EEPROMWEARSIZE must match the counters");
+
+WearBlock s_wear;
+// Counted writes not yet stored.
+uint8_t s_unsaved = 0;
+
+uint16_t wear_crc(const WearBlock& w) {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(w.writes);
+  uint16_t crc = 0xFFFF;
+  for (uint8_t i = 0; i < sizeof(w.writes); i++)
+    crc = _crc_ccitt_update(crc, p[i]);
+  return crc;
+}
+
+void save_wear() {
+  s_wear.crc = wear_crc(s_wear);
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(&s_wear);
+  uint8_t written = 0;
+  for (uint8_t i = 0; i < sizeof(s_wear); i++) {
+    if (EEPROM.read(EEPROMWEARBASE + i) != p[i]) {
+      EEPROM.write(EEPROMWEARBASE + i, p[i]);
+      written++;
+    }
+  }
+  // The block cannot include its own writes; they are stored with the next
+  // save.
+  s_wear.writes[EE_REGION_WEAR] += written;
+  s_unsaved = 0;
+}
+} // namespace
+
+void eeprom_wear_init() {
+  EEPROM.get(EEPROMWEARBASE, s_wear);
+  if (s_wear.crc != wear_crc(s_wear)) {
+    // Fresh part or firmware that did not count; start from zero.
+    memset(s_wear.writes, 0, sizeof(s_wear.writes));
+    save_wear();
+  }
+}
+
+uint8_t eeprom_wear_write(int addr, const void* data, uint8_t len, uint8_t region) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  uint8_t written = 0;
+  for (uint8_t i = 0; i < len; i++) {
+    if (EEPROM.read(addr + i) != p[i]) {
+      EEPROM.write(addr + i, p[i]);
+      written++;
+    }
+  }
+  if (written == 0 || region >= EE_REGION_COUNT)
+    return written;
+  s_wear.writes[region] += written;
+  if ((uint16_t)s_unsaved + written >= EEPROM_WEAR_SAVE_BYTES)
+    save_wear();
+  else
+    s_unsaved += written;
+  return written;
+}
+
+void eeprom_wear_flush() {
+  if (s_unsaved > 0)
+    save_wear();
+}
+
+uint32_t eeprom_wear_writes(uint8_t region) {
+  return region < EE_REGION_COUNT ? s_wear.writes[region] : 0;
+}
+
+uint16_t eeprom_region_size(uint8_t region) {
+  switch (region) {
+  case EE_REGION_NAMES:
+    return EEPROMNAMESIZE;
+  case EE_REGION_CONFIG:
+    return (EEPROMCONFEND - EEPROMCONFBASE) + (EEPROMLOGBASE - EEPROMCURVEBASE);
+  case EE_REGION_PROFILES:
+    return PROFILE_COUNT * PROFILE_SLOT_SIZE;
+  case EE_REGION_LOG:
+    return EEPROMSIZE - EEPROMLOGBASE;
+#if HISTORY_EEPROM_SPILL
+  case EE_REGION_HISTORY:
+    return HISTORY_EEPROM_DEPTH * 12;
+#endif
+  case EE_REGION_WEAR:
+    return EEPROMWEARSIZE;
+  default:
+    return 0;
+  }
+}
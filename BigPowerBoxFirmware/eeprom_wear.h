@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "board_config.h"
+
+// EEPROM regions with their own write counter.
+enum EepromRegion : uint8_t {
+  EE_REGION_NAMES = 0,
+  // Config records and the dew curve.
+  EE_REGION_CONFIG,
+  EE_REGION_PROFILES,
+  EE_REGION_LOG,
+  EE_REGION_HISTORY,
+  // The counter block itself.
+  EE_REGION_WEAR,
+  EE_REGION_COUNT,
+};
+
+// Loads the write counters; call before anything writes EEPROM.
+void eeprom_wear_init();
+// Writes only the bytes that differ and counts them against the region.
+// Returns the number of bytes written.
+uint8_t eeprom_wear_write(int addr, const void* data, uint8_t len, uint8_t region);
+// Stores counts not yet saved. Counts are otherwise saved every
+// EEPROM_WEAR_SAVE_BYTES counted bytes, so call this after writes that should
+// survive a power cut.
+void eeprom_wear_flush();
+// Byte writes counted for a region over the life of the part.
+uint32_t eeprom_wear_writes(uint8_t region);
+uint16_t eeprom_region_size(uint8_t region);
+
+template <typename T> inline void eeprom_wear_put(int addr, const T& value, uint8_t region) {
+  eeprom_wear_write(addr, &value, sizeof(T), region);
+}
+
+inline void eeprom_wear_update(int addr, uint8_t value, uint8_t region) {
+  eeprom_wear_write(addr, &value, 1, region);
+}
@@ -0,0 +1,127 @@
+#include "eventlog.h"
+
+#include <EEPROM.h>
+
+#include "eeprom_wear.h"
+
+// Region layout: magic byte, 16-bit boot counter, then EVENTLOG_DEPTH records.
+// Records are written round-robin with slot = seq % EVENTLOG_DEPTH, so every
+// slot takes the same share of writes.
+
+static_assert((EVENTLOG_DEPTH & (EVENTLOG_DEPTH - 1)) == 0,
+              "EVENTLOG_DEPTH must divide the 16-bit sequence range");
+
+namespace {
+constexpr uint8_t LOG_MAGIC = 0xE7;
+constexpr int LOG_BOOT_ADDR = EEPROMLOGBASE + 1;
+constexpr int LOG_RECORDS_ADDR = EEPROMLOGBASE + 3;
+
+uint16_t boot_count = 0;
+uint16_t next_seq = 0;
+uint8_t count = 0;
+uint8_t last_code = EVENT_EMPTY;
+uint8_t last_arg = 0;
+uint32_t last_ms = 0;
+
+int record_addr(uint16_t seq) {
+  return LOG_RECORDS_ADDR + (int)(seq % EVENTLOG_DEPTH) * (int)sizeof(EventRecord);
+}
+
+uint8_t read_code(uint8_t slot) {
+  return EEPROM.read(LOG_RECORDS_ADDR + slot * (int)sizeof(EventRecord) +
+                     (int)offsetof(EventRecord, code));
+}
+
+uint16_t read_seq(uint8_t slot) {
+  uint16_t seq = 0;
+  EEPROM.get(LOG_RECORDS_ADDR + slot * (int)sizeof(EventRecord), seq);
+  return seq;
+}
+} // namespace
+
+void eventlog_init() {
+  if (EEPROM.read(EEPROMLOGBASE) != LOG_MAGIC) {
+    // Region held config slots or nothing at all; start an empty log.
+    for (uint8_t i = 0; i < EVENTLOG_DEPTH; i++) {
+      eeprom_wear_update(LOG_RECORDS_ADDR + i * (int)sizeof(EventRecord) +
+                           (int)offsetof(EventRecord, code),
+                         EVENT_EMPTY, EE_REGION_LOG);
+    }
+    eeprom_wear_put(LOG_BOOT_ADDR, (uint16_t)0, EE_REGION_LOG);
+    eeprom_wear_update(EEPROMLOGBASE, LOG_MAGIC, EE_REGION_LOG);
+  }
+  EEPROM.get(LOG_BOOT_ADDR, boot_count);
+  boot_count++;
+  eeprom_wear_put(LOG_BOOT_ADDR, boot_count, EE_REGION_LOG);
+
+  // The newest record is the one whose successor slot does not continue
+  // its sequence.
+  count = 0;
+  next_seq = 0;
+  for (uint8_t i = 0; i < EVENTLOG_DEPTH; i++) {
+    if (read_code(i) == EVENT_EMPTY)
+      continue;
+    count++;
+    uint16_t seq = read_seq(i);
+    uint8_t j = (uint8_t)((i + 1) % EVENTLOG_DEPTH);
+    if (read_code(j) == EVENT_EMPTY || read_seq(j) != (uint16_t)(seq + 1))
+      next_seq = (uint16_t)(seq + 1);
+  }
+  last_code = EVENT_EMPTY;
+}
+
+void eventlog_record(uint8_t code, uint8_t arg) {
+  uint32_t now = millis();
+  // Suppress repeats of the same event so a persistent fault cannot wear
+  // through the log.
+  if (code == last_code && arg == last_arg && (now - last_ms) < EVENTLOG_REPEAT_MS)
+    return;
+  last_code = code;
+  last_arg = arg;
+  last_ms = now;
+
+  EventRecord rec;
+  rec.seq = next_seq;
+  rec.boot = boot_count;
+  rec.uptime_ms = now;
+  rec.code = code;
+  rec.arg = arg;
+  eeprom_wear_put(record_addr(next_seq), rec, EE_REGION_LOG);
+  next_seq++;
+  if (count < EVENTLOG_DEPTH)
+    count++;
+}
+
+void eventlog_clear() {
+  for (uint8_t i = 0; i < EVENTLOG_DEPTH; i++) {
+    if (read_code(i) != EVENT_EMPTY) {
+      eeprom_wear_update(LOG_RECORDS_ADDR + i * (int)sizeof(EventRecord) +
+                           (int)offsetof(EventRecord, code),
+                         EVENT_EMPTY, EE_REGION_LOG);
+    }
+  }
+  next_seq = 0;
+  count = 0;
+  last_code = EVENT_EMPTY;
+}
+
+uint16_t eventlog_boot() {
+  return boot_count;
+}
+
+uint16_t eventlog_first() {
+  return (uint16_t)(next_seq - count);
+}
+
+uint16_t eventlog_next() {
+  return next_seq;
+}
+
+bool eventlog_get(uint16_t seq, EventRecord* out) {
+  if (!out)
+    return false;
+  if ((uint16_t)(next_seq - seq) == 0 || (uint16_t)(next_seq - seq) > count)
+    return false;
+  EEPROM.get(record_addr(seq), *out);
+  return out->code != EVENT_EMPTY && out->seq == seq;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "board_config.h"
+
+enum EventCode : uint8_t {
+  // Input overvoltage shutdown; arg is input voltage in decivolts.
+  EVENT_OVERVOLTAGE = 1,
+  // Dew modes suspended after a probe read failure; arg is number of ports.
+  EVENT_DEW_DISABLED = 2,
+  // MCP23017 output write failed; arg is the expander's I2C address.
+  EVENT_MCP_WRITE_FAIL = 3,
+  // Stored config failed validation and was corrected or reset.
+  EVENT_CONFIG_CORRECTED = 4,
+  // Ambient probe found again; arg is number of dew ports resumed.
+  EVENT_PROBE_RESTORED = 5,
+  // One of several ambient probes stopped answering; arg is its I2C address.
+  EVENT_PROBE_FAILOVER = 6,
+  // MCP23017 outputs read back wrong and were rewritten; arg is the
+  // expander's I2C address.
+  EVENT_MCP_RESYNC = 7,
+  EVENT_EMPTY = 0xFF,
+};
+
+struct EventRecord {
+  uint16_t seq;
+  uint16_t boot;
+  uint32_t uptime_ms;
+  uint8_t code;
+  uint8_t arg;
+};
+
+static_assert(sizeof(EventRecord) == EVENTLOG_RECORD_SIZE, "EEPROMLOGBASE assumes 10-byte records");
+
+void eventlog_init();
+void eventlog_record(uint8_t code, uint8_t arg);
+void eventlog_clear();
+uint16_t eventlog_boot();
+uint16_t eventlog_first();
+uint16_t eventlog_next();
+bool eventlog_get(uint16_t seq, EventRecord* out);
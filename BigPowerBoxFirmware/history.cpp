@@ -0,0 +1,90 @@
+#include "history.h"
+
+#include "pwm_out.h"
+
+#if HISTORY_EEPROM_SPILL
+#include <EEPROM.h>
+
+#include "eeprom_wear.h"
+#endif
+
+namespace {
+int16_t milli_to_centi(int32_t milli) {
+  int32_t centi = milli >= 0 ? (milli + 5) / 10 : (milli - 5) / 10;
+  if (centi > 32767)
+    centi = 32767;
+  if (centi < -32768)
+    centi = -32768;
+  return (int16_t)centi;
+}
+
+#if HISTORY_EEPROM_SPILL
+int eeprom_addr(uint32_t seq) {
+  return EEPROMHISTBASE + (int)(seq % HISTORY_EEPROM_DEPTH) * (int)sizeof(HistorySample);
+}
+#endif
+} // namespace
+
+void history_init(History* h) {
+  if (!h)
+    return;
+  h->total = 0;
+}
+
+void history_record(History* h, const Ports* ports) {
+  if (!h || !ports)
+    return;
+  uint8_t slot = (uint8_t)(h->total % HISTORY_DEPTH);
+#if HISTORY_EEPROM_SPILL
+  // Spill the sample about to be overwritten so readout can reach further back.
+  if (h->total >= HISTORY_DEPTH) {
+    eeprom_wear_put(eeprom_addr(h->total - HISTORY_DEPTH), h->buf[slot], EE_REGION_HISTORY);
+  }
+#endif
+  HistorySample* s = &h->buf[slot];
+  int32_t input_mv = ports_get_input_mv(ports);
+  s->input_cv = input_mv > 0 ? (uint16_t)milli_to_centi(input_mv) : 0;
+  s->input_ca = milli_to_centi(ports_get_input_ma(ports));
+  int32_t ports_ma = 0;
+  for (uint8_t i = 0; i < PORT_COUNT; i++) {
+    ports_ma += ports_get_port_ma(ports, i);
+  }
+  s->ports_ca = milli_to_centi(ports_ma);
+  s->flags = 0;
+  s->temp_centi = 0;
+  s->humid_centi = 0;
+  if (ports->have_temp) {
+    s->flags |= HISTORY_FLAG_TEMP;
+    s->temp_centi = (int16_t)ports->temp_centi;
+    s->humid_centi = (uint16_t)ports->humid_centi;
+  }
+  s->dew_duty = pwm_level_to_8bit(ports_max_dew_duty(ports));
+  h->total++;
+}
+
+uint32_t history_first(const History* h) {
+  if (!h)
+    return 0;
+  uint32_t depth = HISTORY_DEPTH;
+#if HISTORY_EEPROM_SPILL
+  depth += HISTORY_EEPROM_DEPTH;
+#endif
+  return h->total > depth ? h->total - depth : 0;
+}
+
+bool history_get(const History* h, uint32_t seq, HistorySample* out) {
+  if (!h || !out)
+    return false;
+  if (seq >= h->total || seq < history_first(h))
+    return false;
+  if (h->total - seq <= HISTORY_DEPTH) {
+    *out = h->buf[seq % HISTORY_DEPTH];
+    return true;
+  }
+#if HISTORY_EEPROM_SPILL
+  EEPROM.get(eeprom_addr(seq), *out);
+  return true;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "board_config.h"
+#include "ports.h"
+
+#define HISTORY_FLAG_TEMP 0x01
+
+// Fixed-point snapshot of the measurements reported by `S`. dew_duty is the
+// highest duty across dew ports on the 0..255 scale.
+struct HistorySample {
+  uint16_t input_cv;
+  int16_t input_ca;
+  int16_t ports_ca;
+  int16_t temp_centi;
+  uint16_t humid_centi;
+  uint8_t dew_duty;
+  uint8_t flags;
+};
+
+static_assert(sizeof(HistorySample) == 12, "EEPROMHISTBASE assumes 12-byte snapshots");
+
+struct History {
+  HistorySample buf[HISTORY_DEPTH];
+  // Number of samples recorded since boot; also the next sequence number.
+  uint32_t total;
+};
+
+extern History g_history;
+
+void history_init(History* h);
+void history_record(History* h, const Ports* ports);
+uint32_t history_first(const History* h);
+bool history_get(const History* h, uint32_t seq, HistorySample* out);
@@ -2,12 +2,154 @@
 
 #include <Wire.h>
 
+namespace {
+// endTransmission() result codes from the AVR Wire library.
+constexpr uint8_t WIRE_OK = 0;
+constexpr uint8_t WIRE_NACK_ADDR = 2;
+constexpr uint8_t WIRE_TIMEOUT = 5;
+
+I2cStats g_i2c;
+
+I2cAddrStats* stats_for(uint8_t addr) {
+  for (uint8_t i = 0; i < g_i2c.count; i++) {
+    if (g_i2c.slot[i].addr == addr)
+      return &g_i2c.slot[i];
+  }
+  if (g_i2c.count >= I2C_STATS_SLOTS)
+    return nullptr;
+  I2cAddrStats* s = &g_i2c.slot[g_i2c.count++];
+  s->addr = addr;
+  s->acked = false;
+  s->tx = 0;
+  s->nack = 0;
+  s->timeout = 0;
+  return s;
+}
+
+void bump(uint16_t* counter) {
+  if (*counter != 0xFFFF)
+    (*counter)++;
+}
+
+// Every driver in this firmware talks to parts rated for 400 kHz.
+bool fast_capable(uint8_t addr) {
+  if (addr >= MCP23017_BASE_ADDR && addr < MCP23017_BASE_ADDR + 8)
+    return true;
+  if (addr >= STRAP_SENSOR_BASE_ADDR && addr < STRAP_SENSOR_BASE_ADDR + PWM_PORT_COUNT)
+    return true;
+  return addr == 0x38 || addr == 0x44 || addr == 0x45 || addr == 0x76 || addr == 0x77;
+}
+
+void begin_wire() {
+  Wire.begin();
+  Wire.setWireTimeout(I2C_TIMEOUT_US, true);
+  Wire.setClock(g_i2c.clock_hz);
+}
+
+// Records the outcome of one transaction and recovers the bus after a
+// timeout. Returns true on success.
+bool note(uint8_t addr, uint8_t result) {
+  I2cAddrStats* s = stats_for(addr);
+  if (s)
+    bump(&s->tx);
+  if (result == WIRE_OK) {
+    if (s)
+      s->acked = true;
+    return true;
+  }
+  if (result == WIRE_TIMEOUT || Wire.getWireTimeoutFlag()) {
+    Wire.clearWireTimeoutFlag();
+    if (s)
+      bump(&s->timeout);
+    i2c_recover();
+  } else if (s) {
+    bump(&s->nack);
+  }
+  return false;
+}
+
+// The lines are driven open-drain: pulled low as an output, released as an
+// input. The output latch is cleared before the pin becomes an output, so a
+// slave holding the line low never sees it driven high.
+void pull_line_low(uint8_t pin) {
+  digitalWrite(pin, LOW);
+  pinMode(pin, OUTPUT);
+}
+
+// Input with the weak internal pull-up, as Wire leaves the lines.
+void release_line(uint8_t pin) {
+  pinMode(pin, INPUT_PULLUP);
+}
+} // namespace
+
+void i2c_init() {
+  g_i2c.count = 0;
+  g_i2c.recoveries = 0;
+  g_i2c.clock_hz = I2C_CLOCK_HZ;
+  pinMode(SDA, INPUT_PULLUP);
+  // A slave left mid-byte by a reset can hold SDA low from power-up.
+  if (digitalRead(SDA) == LOW) {
+    i2c_recover();
+    return;
+  }
+  begin_wire();
+}
+
+void i2c_update_clock() {
+  uint32_t hz = I2C_FAST_CLOCK_HZ;
+  if (g_i2c.recoveries > 0)
+    hz = I2C_CLOCK_HZ;
+  for (uint8_t i = 0; i < g_i2c.count; i++) {
+    if (g_i2c.slot[i].acked && !fast_capable(g_i2c.slot[i].addr))
+      hz = I2C_CLOCK_HZ;
+  }
+  if (hz != g_i2c.clock_hz) {
+    g_i2c.clock_hz = hz;
+    Wire.setClock(hz);
+  }
+}
+
+const I2cStats* i2c_stats() {
+  return &g_i2c;
+}
+
+void i2c_clear_stats() {
+  // Keep the address list so the clock decision still sees every device.
+  for (uint8_t i = 0; i < g_i2c.count; i++) {
+    g_i2c.slot[i].tx = 0;
+    g_i2c.slot[i].nack = 0;
+    g_i2c.slot[i].timeout = 0;
+  }
+  g_i2c.recoveries = 0;
+}
+
+void i2c_recover() {
+  bump(&g_i2c.recoveries);
+  // A long probe cable is the usual culprit; stay at the standard clock.
+  g_i2c.clock_hz = I2C_CLOCK_HZ;
+  Wire.end();
+  release_line(SDA);
+  release_line(SCL);
+  for (uint8_t i = 0; i < 9 && digitalRead(SDA) == LOW; i++) {
+    pull_line_low(SCL);
+    delayMicroseconds(5);
+    release_line(SCL);
+    delayMicroseconds(5);
+  }
+  // STOP: SDA rises while SCL is high.
+  pull_line_low(SDA);
+  delayMicroseconds(5);
+  release_line(SDA);
+  delayMicroseconds(5);
+  begin_wire();
+}
+
 bool i2c_write(uint8_t addr, const uint8_t* data, uint8_t len) {
   Wire.beginTransmission(addr);
   for (uint8_t i = 0; i < len; i++) {
     Wire.write(data[i]);
   }
-  return Wire.endTransmission() == 0;
+  return note(addr, Wire.endTransmission());
 }
 
 bool i2c_write_reg(uint8_t addr, uint8_t reg, const uint8_t* data, uint8_t len) {
@@ -16,12 +158,14 @@ bool i2c_write_reg(uint8_t addr, uint8_t reg, const uint8_t* data, uint8_t len)
   for (uint8_t i = 0; i < len; i++) {
     Wire.write(data[i]);
   }
-  return Wire.endTransmission() == 0;
+  return note(addr, Wire.endTransmission());
 }
 
 bool i2c_read(uint8_t addr, uint8_t* data, uint8_t len) {
   uint8_t got = Wire.requestFrom((int)addr, (int)len);
-  if (got != len)
+  // requestFrom() only reports a byte count; a short read is a NACK unless
+  // the timeout flag is set.
+  if (!note(addr, got == len ? WIRE_OK : WIRE_NACK_ADDR))
     return false;
   for (uint8_t i = 0; i < len; i++) {
     data[i] = Wire.read();
@@ -32,12 +176,12 @@ bool i2c_read(uint8_t addr, uint8_t* data, uint8_t len) {
 bool i2c_read_reg(uint8_t addr, uint8_t reg, uint8_t* data, uint8_t len) {
   Wire.beginTransmission(addr);
   Wire.write(reg);
-  if (Wire.endTransmission(false) != 0)
+  if (!note(addr, Wire.endTransmission(false)))
     return false;
   return i2c_read(addr, data, len);
 }
 
 bool i2c_probe(uint8_t addr) {
   Wire.beginTransmission(addr);
-  return Wire.endTransmission() == 0;
+  return note(addr, Wire.endTransmission());
 }
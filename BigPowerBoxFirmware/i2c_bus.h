@@ -2,8 +2,34 @@
 
 #include <Arduino.h>
 
+#include "board_config.h"
+
+// Transaction counters for one I2C address; they saturate at 0xFFFF.
+struct I2cAddrStats {
+  uint8_t addr;
+  // Set once the address has acknowledged at least once.
+  bool acked;
+  uint16_t tx;
+  uint16_t nack;
+  uint16_t timeout;
+};
+
+struct I2cStats {
+  I2cAddrStats slot[I2C_STATS_SLOTS];
+  uint8_t count;
+  uint16_t recoveries;
+  uint32_t clock_hz;
+};
+
+void i2c_init();
+// Picks the fast clock when every device seen so far supports it.
+void i2c_update_clock();
+const I2cStats* i2c_stats();
+void i2c_clear_stats();
+// Clocks a stuck slave off SDA, issues a STOP and restarts the controller.
+void i2c_recover();
 bool i2c_write(uint8_t addr, const uint8_t* data, uint8_t len);
 bool i2c_write_reg(uint8_t addr, uint8_t reg, const uint8_t* data, uint8_t len);
 bool i2c_read(uint8_t addr, uint8_t* data, uint8_t len);
 bool i2c_read_reg(uint8_t addr, uint8_t reg, uint8_t* data, uint8_t len);
-bool i2c_probe(uint8_t addr);
\ No newline at end of file
+bool i2c_probe(uint8_t addr);
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stdint.h>
+
+// Compile-time index pack for filling flash tables from constexpr functions:
+// a table template specialised on Indices<I...> expands f(I)... over
+// MakeIndices<N>::type, which is Indices<0, 1, ..., N - 1>.
+template <uint8_t... I> struct Indices {};
+template <uint8_t N, uint8_t... I> struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+template <uint8_t... I> struct MakeIndices<0, I...> {
+  typedef Indices<I...> type;
+};
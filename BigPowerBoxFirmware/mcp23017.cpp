@@ -1,52 +1,105 @@
 #include "mcp23017.h"
 
+#include "board_config.h"
 #include "i2c_bus.h"
 
 namespace {
 constexpr uint8_t REG_IODIRA = 0x00;
-constexpr uint8_t REG_IODIRB = 0x01;
 constexpr uint8_t REG_GPIOA = 0x12;
 constexpr uint8_t REG_GPIOB = 0x13;
+constexpr uint8_t REG_OLATA = 0x14;
+
+void bump(uint16_t* counter) {
+  if (*counter != 0xFFFF)
+    (*counter)++;
+}
+
+// With IOCON.BANK = 0 the A and B registers are adjacent, so each pair goes
+// out in one transaction.
+bool write_latches(Mcp23017* m) {
+  uint8_t latch[2] = {m->gpio_a, m->gpio_b};
+  return i2c_write_reg(m->addr, REG_OLATA, latch, 2);
+}
+
+bool write_outputs(Mcp23017* m) {
+  uint8_t dir[2] = {0x00, 0x00}; // all outputs
+  if (!i2c_write_reg(m->addr, REG_IODIRA, dir, 2))
+    return false;
+  return write_latches(m);
+}
 } // namespace
 
-bool mcp23017_init(Mcp23017* m) {
+bool mcp23017_init(Mcp23017* m, uint8_t addr) {
   if (!m)
     return false;
+  m->addr = addr;
   m->gpio_a = 0x00;
   m->gpio_b = 0x00;
+  m->dirty = false;
+  m->retry_ms = 0;
+  m->retry_pending = false;
+  mcp23017_clear_stats(m);
+  return write_outputs(m);
+}
 
-  uint8_t out = 0x00; // all outputs
-  if (!i2c_write_reg(m->addr, REG_IODIRA, &out, 1))
-    return false;
-  if (!i2c_write_reg(m->addr, REG_IODIRB, &out, 1))
-    return false;
-
-  if (!i2c_write_reg(m->addr, REG_GPIOA, &m->gpio_a, 1))
+bool mcp23017_set_pin(Mcp23017* m, uint8_t pin, bool value) {
+  if (!m)
     return false;
-  if (!i2c_write_reg(m->addr, REG_GPIOB, &m->gpio_b, 1))
+  if (pin > 15)
     return false;
-
+  uint8_t* latch = pin < 8 ? &m->gpio_a : &m->gpio_b;
+  uint8_t mask = (uint8_t)(1u << (pin & 7));
+  uint8_t next = value ? (uint8_t)(*latch | mask) : (uint8_t)(*latch & ~mask);
+  if (next != *latch) {
+    *latch = next;
+    m->dirty = true;
+  }
   return true;
 }
 
-bool mcp23017_write_pin(Mcp23017* m, uint8_t pin, bool value) {
-  if (!m)
-    return false;
-  if (pin > 7)
-    return false;
-  if (value) {
-    m->gpio_a |= (1u << pin);
-  } else {
-    m->gpio_a &= ~(1u << pin);
+bool mcp23017_flush(Mcp23017* m) {
+  if (!m || !m->dirty)
+    return true;
+  // Don't hammer a missing expander; retry at the verify cadence.
+  if (m->retry_pending && (millis() - m->retry_ms) < MCP_VERIFY_MS)
+    return true;
+  bump(&m->writes);
+  if (write_latches(m)) {
+    m->dirty = false;
+    m->retry_pending = false;
+    return true;
   }
-  return i2c_write_reg(m->addr, REG_GPIOA, &m->gpio_a, 1);
+  bump(&m->write_fails);
+  m->retry_ms = millis();
+  m->retry_pending = true;
+  return false;
 }
 
-bool mcp23017_write_porta(Mcp23017* m, uint8_t value) {
+bool mcp23017_verify(Mcp23017* m) {
   if (!m)
-    return false;
-  m->gpio_a = value;
-  return i2c_write_reg(m->addr, REG_GPIOA, &m->gpio_a, 1);
+    return true;
+  uint8_t dir[2];
+  uint8_t latch[2];
+  if (!i2c_read_reg(m->addr, REG_IODIRA, dir, 2))
+    return true;
+  if (!i2c_read_reg(m->addr, REG_OLATA, latch, 2))
+    return true;
+  bump(&m->verifies);
+  if (dir[0] == 0x00 && dir[1] == 0x00 && latch[0] == m->gpio_a && latch[1] == m->gpio_b)
+    return true;
+  bump(&m->mismatches);
+  if (write_outputs(m))
+    m->dirty = false;
+  return false;
+}
+
+void mcp23017_clear_stats(Mcp23017* m) {
+  if (!m)
+    return;
+  m->writes = 0;
+  m->write_fails = 0;
+  m->verifies = 0;
+  m->mismatches = 0;
 }
 
 bool mcp23017_read_gpioa(Mcp23017* m, uint8_t* value) {
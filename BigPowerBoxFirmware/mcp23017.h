@@ -4,12 +4,30 @@
 
 struct Mcp23017 {
   uint8_t addr;
+  // Shadow of the OLATA/OLATB output latches; pin changes land here and
+  // reach the chip on the next mcp23017_flush.
   uint8_t gpio_a;
   uint8_t gpio_b;
+  bool dirty;
+  // Last failed flush; the write is retried after MCP_VERIFY_MS.
+  unsigned long retry_ms;
+  bool retry_pending;
+  uint16_t writes;
+  uint16_t write_fails;
+  uint16_t verifies;
+  uint16_t mismatches;
 };
 
-bool mcp23017_init(Mcp23017* m);
-bool mcp23017_write_pin(Mcp23017* m, uint8_t pin, bool value);
-bool mcp23017_write_porta(Mcp23017* m, uint8_t value);
+bool mcp23017_init(Mcp23017* m, uint8_t addr);
+// Pins 0..7 are GPA0..GPA7, 8..15 are GPB0..GPB7.
+bool mcp23017_set_pin(Mcp23017* m, uint8_t pin, bool value);
+// Writes both latches in one transaction when the shadow has changed.
+// Returns false only when a write was attempted and failed.
+bool mcp23017_flush(Mcp23017* m);
+// Reads the direction and latch registers back and rewrites them when they
+// disagree with the shadow, as after a brown-out reset of the expander.
+// Returns false on a mismatch.
+bool mcp23017_verify(Mcp23017* m);
+void mcp23017_clear_stats(Mcp23017* m);
 bool mcp23017_read_gpioa(Mcp23017* m, uint8_t* value);
-bool mcp23017_read_gpiob(Mcp23017* m, uint8_t* value);
\ No newline at end of file
+bool mcp23017_read_gpiob(Mcp23017* m, uint8_t* value);
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Arduino.h>
+#include <string.h>
+
+#include "board_config.h"
+
+// One bit per port, sized from the board signature. Port i is bit i % 8 of
+// byte i / 8, so boards with up to 16 ports keep the layout of a uint16_t
+// mask.
+static constexpr uint8_t PORT_BITS_BYTES = (PORT_COUNT + 7) / 8;
+
+struct PortBits {
+  uint8_t b[PORT_BITS_BYTES];
+};
+
+inline bool port_bits_get(const PortBits* bits, uint8_t i) {
+  return (bits->b[i >> 3] >> (i & 7)) & 0x01;
+}
+
+inline void port_bits_set(PortBits* bits, uint8_t i, bool on) {
+  uint8_t mask = (uint8_t)(1u << (i & 7));
+  if (on)
+    bits->b[i >> 3] |= mask;
+  else
+    bits->b[i >> 3] &= (uint8_t)~mask;
+}
+
+inline void port_bits_clear(PortBits* bits) {
+  memset(bits->b, 0, sizeof(bits->b));
+}
+
+inline bool port_bits_equal(const PortBits* a, const PortBits* b) {
+  return memcmp(a->b, b->b, sizeof(a->b)) == 0;
+}
+
+// Clears bits past PORT_COUNT; returns true if any were set.
+inline bool port_bits_trim(PortBits* bits) {
+  if ((PORT_COUNT & 7) == 0)
+    return false;
+  uint8_t valid = (uint8_t)((1u << (PORT_COUNT & 7)) - 1u);
+  uint8_t* last = &bits->b[PORT_BITS_BYTES - 1];
+  if ((*last & (uint8_t)~valid) == 0)
+    return false;
+  *last &= valid;
+  return true;
+}
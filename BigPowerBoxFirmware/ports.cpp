@@ -1,32 +1,40 @@
 #include "ports.h"
 
+#include "eventlog.h"
+#include "pwm_out.h"
+
 static bool is_pwm_port(uint8_t port_index) {
-  return BOARD_SIGNATURE_BASE[port_index] == 'p';
+  return board_port_type(port_index) == 'p';
 }
 
 static bool is_mcp_port(uint8_t port_index) {
-  return BOARD_SIGNATURE_BASE[port_index] == 'm';
+  return board_port_type(port_index) == 'm';
 }
 
 static bool is_direct_port(uint8_t port_index) {
-  return BOARD_SIGNATURE_BASE[port_index] == 's';
+  return board_port_type(port_index) == 's';
 }
 
 static bool is_always_on(uint8_t port_index) {
-  return BOARD_SIGNATURE_BASE[port_index] == 'a';
+  return board_port_type(port_index) == 'a';
 }
 
-static int8_t pwm_index_from_port(uint8_t port_index) {
-  if (!is_pwm_port(port_index))
-    return -1;
-  uint8_t count = 0;
-  for (uint8_t i = 0; i < port_index; i++) {
-    if (is_pwm_port(i))
-      count++;
-  }
-  if (count >= PWM_PORT_COUNT)
-    return -1;
-  return (int8_t)count;
+// Only updates the expander shadow; ports_flush_outputs writes it out.
+static bool mcp_write(Ports* ports, uint8_t pin, bool on) {
+  uint8_t expander = pin >> 4;
+  if (expander >= MCP23017_COUNT)
+    return false;
+  return mcp23017_set_pin(&ports->mcp[expander], pin & 0x0F, on);
+}
+
+// Move the output towards pwm_level. Decreases apply at once; increases are
+// left to ports_update_ramps() unless the port has no ramp rate.
+static void drive_pwm(Ports* ports, uint8_t pwm_index) {
+  uint16_t target = ports->pwm_level[pwm_index];
+  if (target > ports->pwm_actual[pwm_index] && ports->ramp_pct_s[pwm_index] > 0)
+    return;
+  ports->pwm_actual[pwm_index] = target;
+  pwm_out_set(pwm_index, target);
 }
 
 static int32_t adc_read_mv(uint8_t pin) {
@@ -40,24 +48,28 @@ bool ports_is_controllable(uint8_t port_index) {
   return is_mcp_port(port_index) || is_pwm_port(port_index) || is_direct_port(port_index);
 }
 
-char ports_port_type(uint8_t port_index) {
-  if (port_index >= PORT_COUNT)
-    return '\0';
-  return BOARD_SIGNATURE_BASE[port_index];
-}
-
 void ports_init(Ports* ports) {
   if (!ports)
     return;
+  port_bits_clear(&ports->state);
   for (uint8_t i = 0; i < PORT_COUNT; i++) {
-    ports->state[i] = is_always_on(i);
+    port_bits_set(&ports->state, i, is_always_on(i));
     ports->port_ma[i] = 0;
     ports->port_ma_avg[i].reset();
   }
   for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
     ports->pwm_mode[i] = PWM_MODE_VARIABLE;
     ports->pwm_level[i] = 0;
+    ports->pwm_actual[i] = 0;
+    ports->ramp_pct_s[i] = 0;
+    ports->dew_active[i] = false;
+    ports->dew_duty[i] = 0;
+    ports->dew_slew_level[i] = 0;
+    ports->dew_suspended[i] = 0;
+    dew_pi_reset(&ports->dew_pi[i]);
+    ports->strap_centi[i] = 0;
   }
+  ports->strap_mask = 0;
   ports->input_mv = 0;
   ports->input_ma = 0;
   ports->input_mv_avg.reset();
@@ -70,8 +82,6 @@ void ports_init(Ports* ports) {
   ports->temp_ema.reset();
   ports->humid_ema.reset();
   ports->press_ema.reset();
-  ports->dew_active = false;
-  ports->dew_duty = 0;
   ports->dewpoint_centi = 0;
 #ifdef DEBUG
   ports->debug_override = false;
@@ -79,26 +89,21 @@ void ports_init(Ports* ports) {
   ports->debug_humid_centi = DEBUG_FAKE_HUMID_CENTI;
   ports->debug_fake_probe = false;
 #endif
-  ports->mcp.addr = MCP23017_ADDR;
-  ports->mcp.gpio_a = 0x00;
-  ports->mcp.gpio_b = 0x00;
-
-  // Initialize MCP and set all port A outputs low.
-  mcp23017_init(&ports->mcp);
+  // Initialize the expanders with every output low.
+  for (uint8_t i = 0; i < MCP23017_COUNT; i++)
+    mcp23017_init(&ports->mcp[i], MCP23017_ADDRS[i]);
 
   // Initialize PWM output pins.
+  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++)
+    pwm_out_attach(i, board_port_pin((uint8_t)board_pwm_port(i)));
   for (uint8_t i = 0; i < PORT_COUNT; i++) {
-    if (is_pwm_port(i)) {
-      uint8_t pwm_pin = ports2Pin[i];
-      pinMode(pwm_pin, OUTPUT);
-      analogWrite(pwm_pin, 0);
-    }
     if (is_direct_port(i)) {
-      uint8_t pin = ports2Pin[i];
+      uint8_t pin = board_port_pin(i);
       pinMode(pin, OUTPUT);
       digitalWrite(pin, LOW);
     }
   }
+  pwm_out_begin();
 }
 
 bool ports_set(Ports* ports, uint8_t port_index, bool on) {
@@ -107,25 +112,24 @@ bool ports_set(Ports* ports, uint8_t port_index, bool on) {
   if (!ports_is_controllable(port_index))
     return false;
 
-  ports->state[port_index] = on;
+  port_bits_set(&ports->state, port_index, on);
 
   if (is_mcp_port(port_index)) {
-    uint8_t pin = ports2Pin[port_index];
-    return mcp23017_write_pin(&ports->mcp, pin, on);
+    uint8_t pin = board_port_pin(port_index);
+    return mcp_write(ports, pin, on);
   }
   if (is_direct_port(port_index)) {
-    uint8_t pin = ports2Pin[port_index];
+    uint8_t pin = board_port_pin(port_index);
     digitalWrite(pin, on ? HIGH : LOW);
     return true;
   }
   if (is_pwm_port(port_index)) {
-    int8_t pwm_index = pwm_index_from_port(port_index);
+    int8_t pwm_index = board_pwm_index(port_index);
     if (pwm_index < 0)
       return false;
-    uint8_t pin = ports2Pin[port_index];
     if (ports->pwm_mode[pwm_index] == PWM_MODE_SWITCHABLE) {
-      digitalWrite(pin, on ? HIGH : LOW);
-      ports->pwm_level[pwm_index] = on ? 255 : 0;
+      ports->pwm_level[pwm_index] = on ? PWM_LEVEL_MAX : 0;
+      drive_pwm(ports, pwm_index);
       return true;
     }
     return false;
@@ -133,21 +137,22 @@ bool ports_set(Ports* ports, uint8_t port_index, bool on) {
   return false;
 }
 
-bool ports_set_pwm_level(Ports* ports, uint8_t port_index, uint8_t level) {
+bool ports_set_pwm_level(Ports* ports, uint8_t port_index, uint16_t level) {
   if (!ports || port_index >= PORT_COUNT)
     return false;
   if (!is_pwm_port(port_index))
     return false;
-  int8_t pwm_index = pwm_index_from_port(port_index);
+  int8_t pwm_index = board_pwm_index(port_index);
   if (pwm_index < 0)
     return false;
   if (ports->pwm_mode[pwm_index] != PWM_MODE_VARIABLE)
     return false;
 
-  uint8_t pin = ports2Pin[port_index];
+  if (level > PWM_LEVEL_MAX)
+    return false;
   ports->pwm_level[pwm_index] = level;
-  ports->state[port_index] = (level > 0);
-  analogWrite(pin, level);
+  port_bits_set(&ports->state, port_index, level > 0);
+  drive_pwm(ports, pwm_index);
   return true;
 }
 
@@ -156,36 +161,37 @@ bool ports_set_pwm_mode(Ports* ports, uint8_t port_index, uint8_t mode) {
     return false;
   if (!is_pwm_port(port_index))
     return false;
-  if (mode != PWM_MODE_VARIABLE && mode != PWM_MODE_SWITCHABLE && mode != PWM_MODE_DEW_AMBIENT) {
+  if (mode != PWM_MODE_VARIABLE && mode != PWM_MODE_SWITCHABLE && !ports_is_dew_mode(mode)) {
     return false;
   }
 
-  int8_t pwm_index = pwm_index_from_port(port_index);
+  int8_t pwm_index = board_pwm_index(port_index);
   if (pwm_index < 0)
     return false;
 
   ports->pwm_mode[pwm_index] = mode;
-  uint8_t pin = ports2Pin[port_index];
+  ports->dew_active[pwm_index] = false;
+  ports->dew_duty[pwm_index] = 0;
+  ports->dew_suspended[pwm_index] = 0;
+  dew_pi_reset(&ports->dew_pi[pwm_index]);
   if (mode == PWM_MODE_SWITCHABLE) {
-    bool on = ports->pwm_level[pwm_index] > 0 || ports->state[port_index];
-    digitalWrite(pin, on ? HIGH : LOW);
-    ports->pwm_level[pwm_index] = on ? 255 : 0;
-    ports->state[port_index] = on;
-  } else if (mode == PWM_MODE_DEW_AMBIENT) {
+    bool on = ports->pwm_level[pwm_index] > 0 || port_bits_get(&ports->state, port_index);
+    ports->pwm_level[pwm_index] = on ? PWM_LEVEL_MAX : 0;
+    port_bits_set(&ports->state, port_index, on);
+  } else if (ports_is_dew_mode(mode)) {
     ports->pwm_level[pwm_index] = 0;
-    ports->state[port_index] = false;
-    analogWrite(pin, 0);
+    port_bits_set(&ports->state, port_index, false);
   } else {
-    analogWrite(pin, ports->pwm_level[pwm_index]);
-    ports->state[port_index] = (ports->pwm_level[pwm_index] > 0);
+    port_bits_set(&ports->state, port_index, ports->pwm_level[pwm_index] > 0);
   }
+  drive_pwm(ports, pwm_index);
   return true;
 }
 
 bool ports_get(const Ports* ports, uint8_t port_index) {
   if (!ports || port_index >= PORT_COUNT)
     return false;
-  return ports->state[port_index];
+  return port_bits_get(&ports->state, port_index);
 }
 
 uint8_t ports_get_pwm_mode(const Ports* ports, uint8_t port_index) {
@@ -193,7 +199,7 @@ uint8_t ports_get_pwm_mode(const Ports* ports, uint8_t port_index) {
     return PWM_MODE_VARIABLE;
   if (!is_pwm_port(port_index))
     return PWM_MODE_VARIABLE;
-  int8_t pwm_index = pwm_index_from_port(port_index);
+  int8_t pwm_index = board_pwm_index(port_index);
   if (pwm_index < 0)
     return PWM_MODE_VARIABLE;
   return ports->pwm_mode[pwm_index];
@@ -203,15 +209,15 @@ uint8_t ports_get_status_value(const Ports* ports, uint8_t port_index) {
   if (!ports || port_index >= PORT_COUNT)
     return 0;
   if (!is_pwm_port(port_index)) {
-    return ports->state[port_index] ? 1 : 0;
+    return port_bits_get(&ports->state, port_index) ? 1 : 0;
   }
-  int8_t pwm_index = pwm_index_from_port(port_index);
+  int8_t pwm_index = board_pwm_index(port_index);
   if (pwm_index < 0)
     return 0;
   if (ports->pwm_mode[pwm_index] == PWM_MODE_SWITCHABLE) {
-    return ports->state[port_index] ? 255 : 0;
+    return port_bits_get(&ports->state, port_index) ? 255 : 0;
   }
-  return ports->pwm_level[pwm_index];
+  return pwm_level_to_8bit(ports->pwm_level[pwm_index]);
 }
 
 void ports_update_input_readings(Ports* ports) {
@@ -231,33 +237,36 @@ void ports_all_off(Ports* ports) {
   if (!ports)
     return;
   for (uint8_t i = 0; i < PORT_COUNT; i++) {
-    char type = ports_port_type(i);
+    char type = board_port_type(i);
     if (type == 'a')
       continue;
     if (type == 'm') {
-      mcp23017_write_pin(&ports->mcp, ports2Pin[i], false);
-      ports->state[i] = false;
+      mcp_write(ports, board_port_pin(i), false);
+      port_bits_set(&ports->state, i, false);
     } else if (type == 's') {
-      digitalWrite(ports2Pin[i], LOW);
-      ports->state[i] = false;
+      digitalWrite(board_port_pin(i), LOW);
+      port_bits_set(&ports->state, i, false);
     } else if (type == 'p') {
-      int8_t pwm_index = pwm_index_from_port(i);
+      int8_t pwm_index = board_pwm_index(i);
       if (pwm_index < 0)
         continue;
       ports->pwm_level[pwm_index] = 0;
       ports->pwm_mode[pwm_index] = PWM_MODE_VARIABLE;
-      ports->state[i] = false;
-      analogWrite(ports2Pin[i], 0);
+      ports->dew_active[pwm_index] = false;
+      ports->dew_duty[pwm_index] = 0;
+      ports->dew_suspended[pwm_index] = 0;
+      port_bits_set(&ports->state, i, false);
+      drive_pwm(ports, pwm_index);
     }
   }
-  ports->dew_active = false;
-  ports->dew_duty = 0;
+  // A shutdown can't wait for the flush at the end of loop().
+  ports_flush_outputs(ports);
 }
 
 void ports_update_port_current(Ports* ports, uint8_t port_index) {
   if (!ports || port_index >= PORT_COUNT)
     return;
-  char type = ports_port_type(port_index);
+  char type = board_port_type(port_index);
   int32_t is_mv = adc_read_mv(ISOUT);
 
   if (type == 'a') {
@@ -296,68 +305,163 @@ bool ports_overvoltage(const Ports* ports) {
   return (ports->input_mv / 1000.0f) > MAXINVOLTS;
 }
 
-void ports_apply_dew_duty(Ports* ports, uint8_t duty) {
-  if (!ports)
+void ports_apply_dew_duty(Ports* ports, uint8_t pwm_index, uint16_t duty) {
+  if (!ports || pwm_index >= PWM_PORT_COUNT)
     return;
-  ports->dew_duty = duty;
-  for (uint8_t i = 0; i < PORT_COUNT; i++) {
-    if (ports_port_type(i) != 'p')
-      continue;
-    int8_t pwm_index = pwm_index_from_port(i);
-    if (pwm_index < 0)
-      continue;
-    if (ports->pwm_mode[pwm_index] != PWM_MODE_DEW_AMBIENT)
-      continue;
-    ports->pwm_level[pwm_index] = duty;
-    ports->state[i] = (duty > 0);
-    analogWrite(ports2Pin[i], duty);
+  if (!ports_is_dew_mode(ports->pwm_mode[pwm_index]))
+    return;
+  int8_t port = board_pwm_port(pwm_index);
+  if (port < 0)
+    return;
+  ports->dew_duty[pwm_index] = duty;
+  ports->pwm_level[pwm_index] = duty;
+  port_bits_set(&ports->state, port, duty > 0);
+  drive_pwm(ports, pwm_index);
+}
+
+uint16_t ports_max_dew_duty(const Ports* ports) {
+  if (!ports)
+    return 0;
+  uint16_t duty = 0;
+  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+    if (ports->dew_duty[i] > duty)
+      duty = ports->dew_duty[i];
   }
+  return duty;
 }
 
-void ports_disable_dew_mode(Ports* ports) {
+// Switches dew ports to variable mode with the output off while the ambient
+// probe is missing. The configured mode is remembered for
+// ports_resume_dew_mode and is not written to the stored config.
+uint8_t ports_suspend_dew_mode(Ports* ports) {
   if (!ports)
-    return;
-  for (uint8_t i = 0; i < PORT_COUNT; i++) {
-    if (ports_port_type(i) != 'p')
-      continue;
-    int8_t pwm_index = pwm_index_from_port(i);
-    if (pwm_index < 0)
-      continue;
-    if (ports->pwm_mode[pwm_index] != PWM_MODE_DEW_AMBIENT)
+    return 0;
+  uint8_t suspended = 0;
+  for (uint8_t pwm_index = 0; pwm_index < PWM_PORT_COUNT; pwm_index++) {
+    if (!ports_is_dew_mode(ports->pwm_mode[pwm_index]))
       continue;
+    ports->dew_suspended[pwm_index] = ports->pwm_mode[pwm_index];
     ports->pwm_mode[pwm_index] = PWM_MODE_VARIABLE;
     ports->pwm_level[pwm_index] = 0;
-    ports->state[i] = false;
-    analogWrite(ports2Pin[i], 0);
+    ports->dew_active[pwm_index] = false;
+    ports->dew_duty[pwm_index] = 0;
+    port_bits_set(&ports->state, (uint8_t)board_pwm_port(pwm_index), false);
+    drive_pwm(ports, pwm_index);
+    suspended++;
+  }
+  return suspended;
+}
+
+uint8_t ports_resume_dew_mode(Ports* ports) {
+  if (!ports)
+    return 0;
+  uint8_t resumed = 0;
+  for (uint8_t pwm_index = 0; pwm_index < PWM_PORT_COUNT; pwm_index++) {
+    if (ports->dew_suspended[pwm_index] == 0)
+      continue;
+    // Clears dew_suspended and leaves the output off until the next dew
+    // control pass.
+    uint8_t port = (uint8_t)board_pwm_port(pwm_index);
+    if (ports_set_pwm_mode(ports, port, ports->dew_suspended[pwm_index]))
+      resumed++;
+  }
+  return resumed;
+}
+
+void ports_flush_outputs(Ports* ports) {
+  if (!ports)
+    return;
+  for (uint8_t i = 0; i < MCP23017_COUNT; i++) {
+    Mcp23017* m = &ports->mcp[i];
+    // Log the first failure only; retries of the same write stay quiet.
+    bool retrying = m->retry_pending;
+    if (!mcp23017_flush(m) && !retrying)
+      eventlog_record(EVENT_MCP_WRITE_FAIL, m->addr);
+  }
+}
+
+void ports_verify_outputs(Ports* ports) {
+  if (!ports)
+    return;
+  for (uint8_t i = 0; i < MCP23017_COUNT; i++) {
+    Mcp23017* m = &ports->mcp[i];
+    if (!m->dirty && !mcp23017_verify(m))
+      eventlog_record(EVENT_MCP_RESYNC, m->addr);
+  }
+}
+
+void ports_load(Ports* ports, const PortBits* state, const uint16_t* levels,
+                const uint8_t* modes) {
+  if (!ports || !state || !levels || !modes)
+    return;
+  ports->state = *state;
+  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+    ports->pwm_level[i] = levels[i];
+    ports->pwm_mode[i] = modes[i];
+    ports->dew_active[i] = false;
+    ports->dew_duty[i] = 0;
+    ports->dew_suspended[i] = 0;
+    dew_pi_reset(&ports->dew_pi[i]);
   }
-  ports->dew_active = false;
-  ports->dew_duty = 0;
 }
 
 void ports_apply_config(Ports* ports) {
   if (!ports)
     return;
-  // MCP ports and direct ports use state[].
+  // MCP ports and direct ports use state.
   for (uint8_t i = 0; i < PORT_COUNT; i++) {
-    char type = ports_port_type(i);
+    char type = board_port_type(i);
     if (type == 'm') {
-      mcp23017_write_pin(&ports->mcp, ports2Pin[i], ports->state[i]);
+      mcp_write(ports, board_port_pin(i), port_bits_get(&ports->state, i));
     } else if (type == 's') {
-      digitalWrite(ports2Pin[i], ports->state[i] ? HIGH : LOW);
+      digitalWrite(board_port_pin(i), port_bits_get(&ports->state, i) ? HIGH : LOW);
     } else if (type == 'p') {
-      int8_t pwm_index = pwm_index_from_port(i);
+      int8_t pwm_index = board_pwm_index(i);
       if (pwm_index < 0)
         continue;
       if (ports->pwm_mode[pwm_index] == PWM_MODE_SWITCHABLE) {
-        digitalWrite(ports2Pin[i], ports->state[i] ? HIGH : LOW);
-      } else if (ports->pwm_mode[pwm_index] == PWM_MODE_DEW_AMBIENT) {
-        analogWrite(ports2Pin[i], 0);
+        ports->pwm_level[pwm_index] = port_bits_get(&ports->state, i) ? PWM_LEVEL_MAX : 0;
+      } else if (ports_is_dew_mode(ports->pwm_mode[pwm_index])) {
         ports->pwm_level[pwm_index] = 0;
-        ports->state[i] = false;
+        port_bits_set(&ports->state, i, false);
       } else {
-        analogWrite(ports2Pin[i], ports->pwm_level[pwm_index]);
-        ports->state[i] = (ports->pwm_level[pwm_index] > 0);
+        port_bits_set(&ports->state, i, ports->pwm_level[pwm_index] > 0);
       }
+      drive_pwm(ports, pwm_index);
+    }
+  }
+}
+
+uint8_t ports_update_ramps(Ports* ports, uint32_t dt_ms) {
+  if (!ports)
+    return 0;
+  uint8_t reached = 0;
+  if (dt_ms > 1000)
+    dt_ms = 1000;
+  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+    uint16_t target = ports->pwm_level[i];
+    uint16_t actual = ports->pwm_actual[i];
+    if (actual >= target)
+      continue;
+    uint32_t step = ((uint32_t)ports->ramp_pct_s[i] * PWM_LEVEL_MAX * dt_ms + 50000) / 100000;
+    if (step < 1)
+      step = 1;
+    // A rate set to 0 mid-ramp means no ramp: finish at once.
+    if (ports->ramp_pct_s[i] == 0 || (uint32_t)(target - actual) <= step) {
+      actual = target;
+      if (!ports_is_dew_mode(ports->pwm_mode[i]))
+        reached++;
+    } else {
+      actual = (uint16_t)(actual + step);
     }
+    ports->pwm_actual[i] = actual;
+    pwm_out_set(i, actual);
   }
+  return reached;
+}
+
+bool ports_ramping(const Ports* ports, uint8_t pwm_index) {
+  if (!ports || pwm_index >= PWM_PORT_COUNT)
+    return false;
+  return ports->pwm_actual[pwm_index] != ports->pwm_level[pwm_index];
 }
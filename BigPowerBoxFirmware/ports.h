@@ -3,21 +3,29 @@
 #include <Arduino.h>
 
 #include "board_config.h"
+#include "board_model.h"
+#include "dew_pi.h"
 #include "ema.h"
 #include "mcp23017.h"
+#include "port_bits.h"
 #include "smoothing.h"
 
 struct Ports {
-  bool state[PORT_COUNT];
+  PortBits state;
   uint8_t pwm_mode[PWM_PORT_COUNT];
-  uint8_t pwm_level[PWM_PORT_COUNT];
+  // Requested level, 0..PWM_LEVEL_MAX.
+  uint16_t pwm_level[PWM_PORT_COUNT];
+  // Level on the pin; ramps up towards pwm_level at ramp_pct_s percent of
+  // full scale per second (0 = no ramp) and follows decreases at once.
+  uint16_t pwm_actual[PWM_PORT_COUNT];
+  uint8_t ramp_pct_s[PWM_PORT_COUNT];
   int32_t input_mv;
   int32_t input_ma;
   int32_t port_ma[PORT_COUNT];
   RollingAverage<ADC_SMOOTHING_WINDOW> input_mv_avg;
   RollingAverage<ADC_SMOOTHING_WINDOW> input_ma_avg;
   RollingAverage<ADC_SMOOTHING_WINDOW> port_ma_avg[PORT_COUNT];
-  Mcp23017 mcp;
+  Mcp23017 mcp[MCP23017_COUNT];
   bool have_temp;
   bool have_press;
   int32_t temp_centi;
@@ -26,9 +34,21 @@ struct Ports {
   EmaFilter temp_ema;
   EmaFilter humid_ema;
   EmaFilter press_ema;
-  bool dew_active;
-  uint8_t dew_duty;
+  bool dew_active[PWM_PORT_COUNT];
+  uint16_t dew_duty[PWM_PORT_COUNT];
+  // Slew-limited duty before rounding to 5 % steps; only meaningful while
+  // dew_active is set.
+  uint16_t dew_slew_level[PWM_PORT_COUNT];
+  // Dew mode to restore once the ambient probe is back; 0 when the port is
+  // not suspended.
+  uint8_t dew_suspended[PWM_PORT_COUNT];
+  DewPi dew_pi[PWM_PORT_COUNT];
+  // Bit i set when PWM slot i has a working strap temperature sensor.
+  uint8_t strap_mask;
+  int16_t strap_centi[PWM_PORT_COUNT];
   int32_t dewpoint_centi;
+  // Current adaptive sensor read interval.
+  uint16_t sample_interval_ms;
 #ifdef DEBUG
   bool debug_override;
   int32_t debug_temp_centi;
@@ -37,13 +57,16 @@ struct Ports {
 #endif
 };
 
+inline bool ports_is_dew_mode(uint8_t mode) {
+  return mode == PWM_MODE_DEW_AMBIENT || mode == PWM_MODE_DEW_PI;
+}
+
 void ports_init(Ports* ports);
 bool ports_set(Ports* ports, uint8_t port_index, bool on);
-bool ports_set_pwm_level(Ports* ports, uint8_t port_index, uint8_t level);
+bool ports_set_pwm_level(Ports* ports, uint8_t port_index, uint16_t level);
 bool ports_set_pwm_mode(Ports* ports, uint8_t port_index, uint8_t mode);
 bool ports_get(const Ports* ports, uint8_t port_index);
 bool ports_is_controllable(uint8_t port_index);
-char ports_port_type(uint8_t port_index);
 uint8_t ports_get_pwm_mode(const Ports* ports, uint8_t port_index);
 uint8_t ports_get_status_value(const Ports* ports, uint8_t port_index);
 void ports_update_input_readings(Ports* ports);
@@ -51,8 +74,22 @@ void ports_update_port_current(Ports* ports, uint8_t port_index);
 int32_t ports_get_input_mv(const Ports* ports);
 int32_t ports_get_input_ma(const Ports* ports);
 int32_t ports_get_port_ma(const Ports* ports, uint8_t port_index);
-void ports_apply_dew_duty(Ports* ports, uint8_t duty);
-void ports_disable_dew_mode(Ports* ports);
+void ports_apply_dew_duty(Ports* ports, uint8_t pwm_index, uint16_t duty);
+uint16_t ports_max_dew_duty(const Ports* ports);
+uint8_t ports_update_ramps(Ports* ports, uint32_t dt_ms);
+bool ports_ramping(const Ports* ports, uint8_t pwm_index);
+uint8_t ports_suspend_dew_mode(Ports* ports);
+uint8_t ports_resume_dew_mode(Ports* ports);
+// Writes pending expander pin changes in one transaction; call once per loop.
+void ports_flush_outputs(Ports* ports);
+// Reads the expander outputs back and restores them if they were lost.
+void ports_verify_outputs(Ports* ports);
+// Loads saved port states, PWM levels and modes and clears the dew control
+// state; ports_apply_config then drives the outputs.
+void ports_load(Ports* ports, const PortBits* state, const uint16_t* levels,
+                const uint8_t* modes);
 void ports_apply_config(Ports* ports);
+// Switches every switchable port off, expander outputs included, before
+// returning.
 void ports_all_off(Ports* ports);
 bool ports_overvoltage(const Ports* ports);
\ No newline at end of file
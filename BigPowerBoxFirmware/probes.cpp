@@ -3,39 +3,190 @@
 #include <string.h>
 
 #include "board_config.h"
+#include "dewpoint.h"
+#include "eventlog.h"
+#include "i2c_bus.h"
 
 namespace {
-bool try_sht31(Probes* p, uint8_t addr) {
-  if (sht31_init(&p->sht, addr)) {
-    p->ambient = AMBIENT_SHT31;
-    return true;
+// Ambient probe addresses in detection order.
+const uint8_t AMBIENT_ADDRS[] = {0x44, 0x45, 0x38, 0x76, 0x77};
+constexpr uint8_t AMBIENT_ADDR_COUNT = sizeof(AMBIENT_ADDRS) / sizeof(AMBIENT_ADDRS[0]);
+
+// Separate pressure sensor addresses, tried when no ambient probe has one.
+const uint8_t PRESSURE_ADDRS[] = {0x76, 0x77};
+constexpr uint8_t PRESSURE_ADDR_COUNT = sizeof(PRESSURE_ADDRS) / sizeof(PRESSURE_ADDRS[0]);
+
+// Starts the init of whichever driver belongs at a known ambient address.
+// The init is split like the reads; poll_ambient_init issues at most one
+// transaction per call.
+void start_ambient_init(AmbientProbe* a, uint8_t addr) {
+  switch (addr) {
+  case 0x44:
+  case 0x45:
+    a->type = AMBIENT_SHT31;
+    sht31_init_start(&a->sht, addr);
+    break;
+  case 0x38:
+    a->type = AMBIENT_AHTX0;
+    ahtx0_init_start(&a->aht, addr);
+    break;
+  case 0x76:
+  case 0x77:
+    a->type = AMBIENT_BME280;
+    bme280_init_start(&a->bme, addr);
+    break;
+  default:
+    a->type = AMBIENT_NONE;
+    break;
   }
-  return false;
 }
 
-bool try_ahtx0(Probes* p, uint8_t addr) {
-  if (ahtx0_init(&p->aht, addr)) {
-    p->ambient = AMBIENT_AHTX0;
-    return true;
+SensorStatus poll_ambient_init(AmbientProbe* a) {
+  switch (a->type) {
+  case AMBIENT_SHT31:
+    return sht31_init_poll(&a->sht);
+  case AMBIENT_AHTX0:
+    return ahtx0_init_poll(&a->aht);
+  case AMBIENT_BME280:
+    return bme280_init_poll(&a->bme);
+  default:
+    return SENSOR_ERROR;
   }
-  return false;
 }
 
-bool try_bme280(Probes* p, uint8_t addr) {
-  if (bme280_init(&p->bme, addr)) {
-    p->ambient = AMBIENT_BME280;
-    p->pressure = PRESS_BME280;
+// Strap sensors are optional; a failed read drops the port back to the
+// ambient model until the next detection. Reads one strap per call and
+// returns false once every strap has been visited.
+bool update_next_strap(Probes* p, Ports* ports) {
+  while (p->strap_next < PWM_PORT_COUNT) {
+    uint8_t i = p->strap_next++;
+    uint8_t bit = (uint8_t)(1u << i);
+    if (!(ports->strap_mask & bit))
+      continue;
+    int16_t t_centi = 0;
+    if (tmp102_read(&p->strap[i], &t_centi)) {
+      ports->strap_centi[i] = t_centi;
+    } else {
+      ports->strap_mask &= (uint8_t)~bit;
+    }
     return true;
   }
   return false;
 }
 
-bool try_bmp280(Probes* p, uint8_t addr) {
-  if (bmp280_init(&p->bmp, addr)) {
-    p->pressure = PRESS_BMP280;
+bool trigger_ambient(AmbientProbe* a) {
+  switch (a->type) {
+  case AMBIENT_SHT31:
+    return sht31_trigger(&a->sht);
+  case AMBIENT_AHTX0:
+    return ahtx0_trigger(&a->aht);
+  case AMBIENT_BME280:
+    // Free-running in normal mode; nothing to start.
     return true;
+  default:
+    return false;
   }
-  return false;
+}
+
+SensorStatus collect_ambient(AmbientProbe* a, int16_t* t_centi, uint16_t* rh_centi,
+                             uint32_t* p_pa) {
+  switch (a->type) {
+  case AMBIENT_SHT31:
+    return sht31_collect(&a->sht, t_centi, rh_centi);
+  case AMBIENT_AHTX0:
+    return ahtx0_collect(&a->aht, t_centi, rh_centi);
+  case AMBIENT_BME280:
+    return bme280_read(&a->bme, t_centi, rh_centi, p_pa) ? SENSOR_DONE : SENSOR_ERROR;
+  default:
+    return SENSOR_ERROR;
+  }
+}
+
+// Checks whether a failed probe answers again. That is a single address
+// probe; the driver init is left to reinit_step between read cycles.
+void check_ambient(Probes* p, AmbientProbe* a) {
+  uint8_t slot = (uint8_t)(a - p->ambient);
+  if (slot != p->reinit_slot && i2c_probe(probes_ambient_addr(a)))
+    p->reinit_mask |= (uint8_t)(1u << slot);
+}
+
+// Re-initialises the probes flagged by check_ambient one at a time, one init
+// step per call. A probe rejoins the fused reading from the next cycle.
+void reinit_step(Probes* p) {
+  if (p->reinit_slot >= AMBIENT_MAX) {
+    for (uint8_t i = 0; i < p->ambient_count; i++) {
+      uint8_t bit = (uint8_t)(1u << i);
+      if (!(p->reinit_mask & bit))
+        continue;
+      p->reinit_mask &= (uint8_t)~bit;
+      p->reinit_slot = i;
+      AmbientProbe* a = &p->ambient[i];
+      start_ambient_init(a, probes_ambient_addr(a));
+      return;
+    }
+    return;
+  }
+  AmbientProbe* a = &p->ambient[p->reinit_slot];
+  SensorStatus st = poll_ambient_init(a);
+  if (st == SENSOR_BUSY)
+    return;
+  if (st == SENSOR_DONE)
+    a->ok = true;
+  p->reinit_slot = AMBIENT_MAX;
+}
+
+void drop_ambient(Probes* p, AmbientProbe* a) {
+  // With a single probe the caller logs the dew modes it suspends instead.
+  if (a->ok && p->ambient_count > 1)
+    eventlog_record(EVENT_PROBE_FAILOVER, probes_ambient_addr(a));
+  a->ok = false;
+}
+
+// Picks one reading from the probes read this cycle according to the fusion
+// mode; false when none of them answered.
+bool fuse(const Probes* p, int32_t* t_centi, int32_t* rh_centi) {
+  int32_t t_sum = 0;
+  int32_t rh_sum = 0;
+  uint8_t n = 0;
+  const AmbientProbe* pick = nullptr;
+  int32_t pick_margin = 0;
+  for (uint8_t i = 0; i < p->ambient_count; i++) {
+    if (!(p->read_mask & (1u << i)))
+      continue;
+    const AmbientProbe* a = &p->ambient[i];
+    t_sum += a->t_centi;
+    rh_sum += a->rh_centi;
+    n++;
+    if (p->fusion == FUSION_MIN_MARGIN) {
+      int32_t margin = dew_margin_centi(a->t_centi, a->rh_centi);
+      if (!pick || margin < pick_margin) {
+        pick = a;
+        pick_margin = margin;
+      }
+    } else if (!pick || probes_ambient_addr(a) == p->primary_addr) {
+      pick = a;
+    }
+  }
+  if (n == 0)
+    return false;
+  if (p->fusion == FUSION_AVERAGE) {
+    *t_centi = t_sum / n;
+    *rh_centi = rh_sum / n;
+  } else {
+    *t_centi = pick->t_centi;
+    *rh_centi = pick->rh_centi;
+  }
+  return true;
+}
+
+void apply_pressure(Ports* ports, uint32_t press_pa) {
+  int32_t press_hpa = (int32_t)(press_pa / 100);
+  ports->pressure_hpa = ports->press_ema.update(press_hpa, SENSOR_EMA_ALPHA);
+}
+
+ProbeStatus finish(Probes* p, ProbeStatus status) {
+  p->stage = PROBE_STAGE_IDLE;
+  return status;
 }
 
 void update_signature(bool have_temp, bool have_press) {
@@ -49,36 +200,125 @@ void update_signature(bool have_temp, bool have_press) {
   g_board_signature[len] = have_press ? 'g' : 'f';
   g_board_signature[len + 1] = '\0';
 }
-} // namespace
 
-void probes_detect(Probes* p, Ports* ports) {
-  if (!p || !ports)
-    return;
-  p->ambient = AMBIENT_NONE;
+void detect_begin(Probes* p, Ports* ports) {
+  p->ambient_count = 0;
   p->pressure = PRESS_NONE;
-  ports->have_temp = false;
-  ports->have_press = false;
+  p->reinit_mask = 0;
+  p->reinit_slot = AMBIENT_MAX;
+  p->detect = DETECT_AMBIENT;
+  p->detect_next = 0;
+  ports->strap_mask = 0;
+}
 
-  if (try_sht31(p, 0x44) || try_sht31(p, 0x45)) {
-    ports->have_temp = true;
-  } else if (try_ahtx0(p, 0x38)) {
-    ports->have_temp = true;
-  } else if (try_bme280(p, 0x76) || try_bme280(p, 0x77)) {
-    ports->have_temp = true;
-    ports->have_press = true;
+// Advances detection by one address probe or driver init step. Returns true
+// once the straps have been checked and ports shows what was found.
+bool detect_step(Probes* p, Ports* ports) {
+  switch (p->detect) {
+  case DETECT_AMBIENT:
+    if (p->detect_next < AMBIENT_ADDR_COUNT && p->ambient_count < AMBIENT_MAX) {
+      uint8_t addr = AMBIENT_ADDRS[p->detect_next++];
+      if (i2c_probe(addr)) {
+        start_ambient_init(&p->ambient[p->ambient_count], addr);
+        p->detect = DETECT_AMBIENT_INIT;
+      }
+      return false;
+    }
+    p->detect_next = 0;
+    if (p->ambient_count > 0 && p->pressure == PRESS_NONE) {
+      bmp280_init_start(&p->bmp, PRESSURE_ADDRS[0]);
+      p->detect = DETECT_PRESSURE;
+    } else {
+      p->detect = DETECT_STRAPS;
+    }
+    return false;
+  case DETECT_AMBIENT_INIT: {
+    AmbientProbe* a = &p->ambient[p->ambient_count];
+    SensorStatus st = poll_ambient_init(a);
+    if (st == SENSOR_BUSY)
+      return false;
+    if (st == SENSOR_DONE) {
+      a->ok = true;
+      if (a->type == AMBIENT_BME280 && p->pressure == PRESS_NONE) {
+        p->pressure = PRESS_BME280;
+        p->pressure_slot = p->ambient_count;
+      }
+      p->ambient_count++;
+    }
+    p->detect = DETECT_AMBIENT;
+    return false;
   }
-
-  if (ports->have_temp && !ports->have_press) {
-    if (try_bmp280(p, 0x76) || try_bmp280(p, 0x77)) {
-      ports->have_press = true;
+  case DETECT_PRESSURE: {
+    SensorStatus st = bmp280_init_poll(&p->bmp);
+    if (st == SENSOR_BUSY)
+      return false;
+    if (st == SENSOR_DONE) {
+      p->pressure = PRESS_BMP280;
+    } else if (++p->detect_next < PRESSURE_ADDR_COUNT) {
+      bmp280_init_start(&p->bmp, PRESSURE_ADDRS[p->detect_next]);
+      return false;
     }
+    p->detect_next = 0;
+    p->detect = DETECT_STRAPS;
+    return false;
   }
+  case DETECT_STRAPS:
+    if (p->detect_next < PWM_PORT_COUNT) {
+      uint8_t i = p->detect_next++;
+      if (tmp102_init(&p->strap[i], (uint8_t)(STRAP_SENSOR_BASE_ADDR + i)))
+        ports->strap_mask |= (uint8_t)(1u << i);
+      return false;
+    }
+    p->detect = DETECT_IDLE;
+    ports->have_temp = p->ambient_count > 0;
+    ports->have_press = p->pressure != PRESS_NONE;
+    update_signature(ports->have_temp, ports->have_press);
+    return true;
+  default:
+    return true;
+  }
+}
+ProbeStatus finish_cycle(Probes* p, Ports* ports) {
+  int32_t t_centi = 0;
+  int32_t rh_centi = 0;
+  if (!fuse(p, &t_centi, &rh_centi))
+    return finish(p, PROBE_FAIL);
+  ports->temp_centi = ports->temp_ema.update(t_centi, SENSOR_EMA_ALPHA);
+  ports->humid_centi = ports->humid_ema.update(rh_centi, SENSOR_EMA_ALPHA);
+  return finish(p, PROBE_DONE);
+}
 
-  if (p->ambient == AMBIENT_BME280) {
-    ports->have_press = true;
+// Moves on to the next ambient probe, then the separate pressure sensor.
+ProbeStatus next_ambient(Probes* p, Ports* ports) {
+  if (++p->current < p->ambient_count) {
+    p->stage = PROBE_STAGE_TRIGGER;
+    return PROBE_BUSY;
   }
+  if (ports->have_press && p->pressure == PRESS_BMP280) {
+    p->stage = PROBE_STAGE_PRESSURE;
+    return PROBE_BUSY;
+  }
+  return finish_cycle(p, ports);
+}
+} // namespace
 
-  update_signature(ports->have_temp, ports->have_press);
+uint8_t probes_ambient_addr(const AmbientProbe* a) {
+  // Every driver struct starts with its I2C address.
+  return a->sht.addr;
+}
+
+void probes_detect(Probes* p, Ports* ports) {
+  if (!p || !ports)
+    return;
+  p->stage = PROBE_STAGE_IDLE;
+  p->scan_next = 0;
+  p->scan_interval_ms = PROBE_RESCAN_MIN_MS;
+  p->scan_ms = millis();
+  ports->have_temp = false;
+  ports->have_press = false;
+  detect_begin(p, ports);
+  while (!detect_step(p, ports))
+    delay(1);
 
 #ifdef DEBUG
 #if DEBUG_FAKE_PROBE
@@ -96,62 +336,132 @@ void probes_detect(Probes* p, Ports* ports) {
 #endif
 }
 
-bool probes_update(Probes* p, Ports* ports) {
+void probes_lost(Probes* p, Ports* ports) {
   if (!p || !ports)
-    return false;
-  if (!ports->have_temp)
-    return false;
+    return;
+  p->ambient_count = 0;
+  p->pressure = PRESS_NONE;
+  p->stage = PROBE_STAGE_IDLE;
+  p->reinit_mask = 0;
+  p->reinit_slot = AMBIENT_MAX;
+  p->detect = DETECT_IDLE;
+  p->scan_next = 0;
+  p->scan_interval_ms = PROBE_RESCAN_MIN_MS;
+  p->scan_ms = millis();
+  ports->have_temp = false;
+  ports->have_press = false;
+  ports->temp_ema.reset();
+  ports->humid_ema.reset();
+  ports->press_ema.reset();
+  update_signature(false, false);
+}
 
-#ifdef DEBUG
-  if (ports->debug_override) {
-    ports->temp_centi = ports->temp_ema.update(ports->debug_temp_centi, SENSOR_EMA_ALPHA);
-    ports->humid_centi = ports->humid_ema.update(ports->debug_humid_centi, SENSOR_EMA_ALPHA);
-    return true;
+bool probes_rescan(Probes* p, Ports* ports) {
+  if (!p || !ports || ports->have_temp)
+    return false;
+  unsigned long now = millis();
+  if (p->detect != DETECT_IDLE) {
+    if (!detect_step(p, ports))
+      return false;
+    if (ports->have_temp)
+      return true;
+    // Something answered but is not a usable probe; keep backing off.
+  } else {
+    if (p->scan_next == 0 && (now - p->scan_ms) < p->scan_interval_ms)
+      return false;
+    // Full detection also picks up a separate pressure sensor and straps.
+    if (i2c_probe(AMBIENT_ADDRS[p->scan_next++]))
+      detect_begin(p, ports);
   }
-  if (ports->debug_fake_probe) {
-    ports->temp_centi = ports->temp_ema.update(DEBUG_FAKE_TEMP_CENTI, SENSOR_EMA_ALPHA);
-    ports->humid_centi = ports->humid_ema.update(DEBUG_FAKE_HUMID_CENTI, SENSOR_EMA_ALPHA);
-    return true;
+  if (p->scan_next >= AMBIENT_ADDR_COUNT) {
+    p->scan_next = 0;
+    p->scan_ms = now;
+    uint32_t next = (uint32_t)p->scan_interval_ms * 2;
+    p->scan_interval_ms = (uint16_t)(next > PROBE_RESCAN_MAX_MS ? PROBE_RESCAN_MAX_MS : next);
   }
-#endif
+  return false;
+}
 
-  int16_t t_centi = 0;
-  uint16_t rh_centi = 0;
-  uint32_t p_pa = 0;
+void probes_start(Probes* p) {
+  if (!p || p->stage != PROBE_STAGE_IDLE)
+    return;
+  p->strap_next = 0;
+  p->stage = PROBE_STAGE_STRAPS;
+}
 
-  switch (p->ambient) {
-  case AMBIENT_SHT31:
-    if (!sht31_read(&p->sht, &t_centi, &rh_centi))
-      return false;
-    break;
-  case AMBIENT_AHTX0:
-    if (!ahtx0_read(&p->aht, &t_centi, &rh_centi))
-      return false;
-    break;
-  case AMBIENT_BME280:
-    if (!bme280_read(&p->bme, &t_centi, &rh_centi, &p_pa))
-      return false;
-    break;
-  default:
-    return false;
+ProbeStatus probes_update(Probes* p, Ports* ports) {
+  if (!p || !ports)
+    return PROBE_IDLE;
+  if (p->stage == PROBE_STAGE_IDLE) {
+    if (ports->have_temp && (p->reinit_mask || p->reinit_slot < AMBIENT_MAX))
+      reinit_step(p);
+    return PROBE_IDLE;
   }
+  if (!ports->have_temp)
+    return finish(p, PROBE_FAIL);
 
-  ports->temp_centi = ports->temp_ema.update(t_centi, SENSOR_EMA_ALPHA);
-  ports->humid_centi = ports->humid_ema.update(rh_centi, SENSOR_EMA_ALPHA);
-
-  if (ports->have_press) {
-    uint32_t press_pa = 0;
-    if (p->pressure == PRESS_BME280) {
-      press_pa = p_pa;
-    } else if (p->pressure == PRESS_BMP280) {
-      int16_t tmp = 0;
-      if (!bmp280_read(&p->bmp, &tmp, &press_pa)) {
-        // Pressure is optional; keep last value if the read fails.
-        return true;
-      }
+  switch (p->stage) {
+  case PROBE_STAGE_STRAPS:
+    if (update_next_strap(p, ports))
+      return PROBE_BUSY;
+#ifdef DEBUG
+    if (ports->debug_override) {
+      ports->temp_centi = ports->temp_ema.update(ports->debug_temp_centi, SENSOR_EMA_ALPHA);
+      ports->humid_centi = ports->humid_ema.update(ports->debug_humid_centi, SENSOR_EMA_ALPHA);
+      return finish(p, PROBE_DONE);
+    }
+    if (ports->debug_fake_probe) {
+      ports->temp_centi = ports->temp_ema.update(DEBUG_FAKE_TEMP_CENTI, SENSOR_EMA_ALPHA);
+      ports->humid_centi = ports->humid_ema.update(DEBUG_FAKE_HUMID_CENTI, SENSOR_EMA_ALPHA);
+      return finish(p, PROBE_DONE);
+    }
+#endif
+    p->current = 0;
+    p->read_mask = 0;
+    p->stage = PROBE_STAGE_TRIGGER;
+    // No transaction issued yet this call; go straight to the trigger.
+    // fall through
+  case PROBE_STAGE_TRIGGER: {
+    AmbientProbe* a = &p->ambient[p->current];
+    if (!a->ok) {
+      check_ambient(p, a);
+      return next_ambient(p, ports);
+    }
+    if (!trigger_ambient(a)) {
+      drop_ambient(p, a);
+      return next_ambient(p, ports);
     }
-    int32_t press_hpa = (int32_t)(press_pa / 100);
-    ports->pressure_hpa = ports->press_ema.update(press_hpa, SENSOR_EMA_ALPHA);
+    p->stage = PROBE_STAGE_COLLECT;
+    return PROBE_BUSY;
+  }
+  case PROBE_STAGE_COLLECT: {
+    AmbientProbe* a = &p->ambient[p->current];
+    int16_t t_centi = 0;
+    uint16_t rh_centi = 0;
+    uint32_t p_pa = 0;
+    SensorStatus st = collect_ambient(a, &t_centi, &rh_centi, &p_pa);
+    if (st == SENSOR_BUSY)
+      return PROBE_BUSY;
+    if (st == SENSOR_ERROR) {
+      drop_ambient(p, a);
+    } else {
+      a->t_centi = t_centi;
+      a->rh_centi = rh_centi;
+      p->read_mask |= (uint8_t)(1u << p->current);
+      if (p->pressure == PRESS_BME280 && p->current == p->pressure_slot)
+        apply_pressure(ports, p_pa);
+    }
+    return next_ambient(p, ports);
+  }
+  case PROBE_STAGE_PRESSURE: {
+    int16_t tmp = 0;
+    uint32_t press_pa = 0;
+    // Pressure is optional; keep last value if the read fails.
+    if (bmp280_read(&p->bmp, &tmp, &press_pa))
+      apply_pressure(ports, press_pa);
+    return finish_cycle(p, ports);
+  }
+  default:
+    return finish(p, PROBE_IDLE);
   }
-  return true;
 }
@@ -7,19 +7,94 @@
 #include "bmp280.h"
 #include "ports.h"
 #include "sht31.h"
+#include "tmp102.h"
 
 enum AmbientType : uint8_t { AMBIENT_NONE = 0, AMBIENT_SHT31, AMBIENT_AHTX0, AMBIENT_BME280 };
 
 enum PressureType : uint8_t { PRESS_NONE = 0, PRESS_BME280, PRESS_BMP280 };
 
+// One read cycle walks these stages, issuing at most one I2C transaction per
+// probes_update call so the main loop never waits on a conversion.
+enum ProbeStage : uint8_t {
+  PROBE_STAGE_IDLE = 0,
+  PROBE_STAGE_STRAPS,
+  PROBE_STAGE_TRIGGER,
+  PROBE_STAGE_COLLECT,
+  PROBE_STAGE_PRESSURE
+};
+
+enum ProbeStatus : uint8_t { PROBE_IDLE = 0, PROBE_BUSY, PROBE_DONE, PROBE_FAIL };
+
+// Detection walks these stages, issuing one address probe or one driver init
+// step per call.
+enum DetectStage : uint8_t {
+  DETECT_IDLE = 0,
+  DETECT_AMBIENT,
+  DETECT_AMBIENT_INIT,
+  DETECT_PRESSURE,
+  DETECT_STRAPS
+};
+
+// One detected ambient probe and its latest raw reading.
+struct AmbientProbe {
+  AmbientType type;
+  // Cleared when a read fails; the probe is re-initialised once it answers
+  // again and left out of the fused reading until then.
+  bool ok;
+  int16_t t_centi;
+  uint16_t rh_centi;
+  union {
+    Sht31 sht;
+    Ahtx0 aht;
+    Bme280 bme;
+  };
+};
+
 struct Probes {
-  AmbientType ambient;
+  AmbientProbe ambient[AMBIENT_MAX];
+  uint8_t ambient_count;
+  // Fusion settings, copied from the config.
+  uint8_t fusion;
+  uint8_t primary_addr;
   PressureType pressure;
-  Sht31 sht;
-  Ahtx0 aht;
-  Bme280 bme;
+  // Ambient slot supplying pressure when pressure == PRESS_BME280.
+  uint8_t pressure_slot;
   Bmp280 bmp;
+  Tmp102 strap[PWM_PORT_COUNT];
+  ProbeStage stage;
+  uint8_t strap_next;
+  // Ambient slot being read and the slots read successfully this cycle.
+  uint8_t current;
+  uint8_t read_mask;
+  // Failed ambient slots that answered again and wait to be re-initialised,
+  // and the slot whose re-init is running (AMBIENT_MAX when none).
+  uint8_t reinit_mask;
+  uint8_t reinit_slot;
+  // Detection stage and the next address or strap it checks.
+  DetectStage detect;
+  uint8_t detect_next;
+  // Hot-plug rescan state while no ambient probe is present.
+  uint8_t scan_next;
+  uint16_t scan_interval_ms;
+  unsigned long scan_ms;
 };
 
+extern Probes g_probes;
+
+// Finds and initialises the probes, the pressure sensor and the straps.
+// Blocks until done; at boot there is nothing else to serve yet.
 void probes_detect(Probes* p, Ports* ports);
-bool probes_update(Probes* p, Ports* ports);
+uint8_t probes_ambient_addr(const AmbientProbe* a);
+// Drops the ambient probes after every one of them failed a read cycle and
+// starts rescanning for them.
+void probes_lost(Probes* p, Ports* ports);
+// Call every loop iteration. While no probe is present, checks one known
+// probe address per call; once one answers, runs detection one step per call
+// and returns true when probes have been found and initialised.
+bool probes_rescan(Probes* p, Ports* ports);
+// Begins a read cycle; ignored while one is still in progress.
+void probes_start(Probes* p);
+// Advances the current cycle. Call every loop iteration; PROBE_DONE or
+// PROBE_FAIL is reported once when the cycle ends. Between cycles, advances
+// the re-init of a recovered probe by one step instead.
+ProbeStatus probes_update(Probes* p, Ports* ports);
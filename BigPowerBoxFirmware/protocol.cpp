@@ -11,10 +11,10 @@ void protocol_handle(char* cmd, Ports* ports) {
     return;
   }
 
-  char* argv[3] = {nullptr, nullptr, nullptr};
+  char* argv[MAXARGS] = {};
   uint8_t argc = 0;
   char* token = strtok(cmd, ":");
-  while (token && argc < 3) {
+  while (token && argc < MAXARGS) {
     argv[argc++] = token;
     token = strtok(nullptr, ":");
   }
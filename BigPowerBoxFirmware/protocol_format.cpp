@@ -1,8 +1,13 @@
 #include "protocol_format.h"
 
 #include "board_config.h"
+#include "dewpoint.h"
 #include "eeprom_cfg.h"
+#include "eeprom_wear.h"
+#include "eventlog.h"
 #include "serial_out.h"
+#include "stack_monitor.h"
+#include "timing.h"
 
 namespace {
 void print_fixed_from_milli(int32_t milli) {
@@ -79,6 +84,33 @@ void protocol_send_status(const Ports* ports) {
   out(EOCOMMAND);
 }
 
+void protocol_send_extended_status(const Ports* ports, const Trend* trend) {
+  out(SOCOMMAND);
+  out('V');
+  out(':');
+  // Fields stay in place and are left empty when there is no data for them.
+  if (ports->have_temp)
+    print_centi(ports->temp_centi - ports->dewpoint_centi);
+  out(':');
+  int32_t proj_t, proj_rh;
+  if (ports->have_temp && trend_project(trend, &proj_t, &proj_rh))
+    print_centi(dew_margin_centi(proj_t, proj_rh));
+  out(':');
+  int32_t rate;
+  if (ports->have_temp && trend_temp_rate(trend, &rate))
+    print_centi(rate);
+  out(':');
+  out((uint32_t)ports->sample_interval_ms);
+  // Requested and actual level of each PWM port; they differ while ramping.
+  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+    out(':');
+    out((uint32_t)ports->pwm_level[i]);
+    out(':');
+    out((uint32_t)ports->pwm_actual[i]);
+  }
+  out(EOCOMMAND);
+}
+
 void protocol_send_discovery() {
   out(SOCOMMAND);
   out('D');
@@ -91,6 +123,46 @@ void protocol_send_discovery() {
   out(EOCOMMAND);
 }
 
+void protocol_send_ambient_probes(const Probes* p) {
+  out(SOCOMMAND);
+  out('E');
+  out(':');
+  out(p->fusion);
+  out(':');
+  out(p->primary_addr);
+  out(':');
+  out(p->ambient_count);
+  for (uint8_t i = 0; i < p->ambient_count; i++) {
+    const AmbientProbe* a = &p->ambient[i];
+    out(':');
+    out((uint8_t)a->type);
+    out(':');
+    out(probes_ambient_addr(a));
+    out(':');
+    out((uint8_t)(a->ok ? 1 : 0));
+    // The last reading is left out while the probe is not answering.
+    out(':');
+    if (a->ok)
+      print_centi(a->t_centi);
+    out(':');
+    if (a->ok)
+      print_centi(a->rh_centi);
+  }
+  out(EOCOMMAND);
+}
+
+void protocol_send_sample_interval(uint16_t min_ms, uint16_t max_ms, uint16_t current_ms) {
+  out(SOCOMMAND);
+  out('I');
+  out(':');
+  out((uint32_t)min_ms);
+  out(':');
+  out((uint32_t)max_ms);
+  out(':');
+  out((uint32_t)current_ms);
+  out(EOCOMMAND);
+}
+
 void protocol_send_pwm_mode(uint8_t port, uint8_t mode) {
   out(SOCOMMAND);
   out('G');
@@ -103,7 +175,19 @@ void protocol_send_pwm_mode(uint8_t port, uint8_t mode) {
   out(EOCOMMAND);
 }
 
-void protocol_send_dew_margin(uint8_t port) {
+void protocol_send_ramp_rate(uint8_t port, uint8_t pct_s) {
+  out(SOCOMMAND);
+  out('Z');
+  out(':');
+  if (port < 10)
+    out('0');
+  out(port);
+  out(':');
+  out(pct_s);
+  out(EOCOMMAND);
+}
+
+void protocol_send_dew_margin(uint8_t port, int16_t m_on_centi) {
   out(SOCOMMAND);
   out('H');
   out(':');
@@ -112,7 +196,7 @@ void protocol_send_dew_margin(uint8_t port) {
   out(port);
   out(':');
   // Legacy protocol expects whole degrees C for the dew margin.
-  out((int32_t)(g_config.dew_m_on_centi / 100));
+  out((int32_t)(m_on_centi / 100));
   out(EOCOMMAND);
 }
 
@@ -128,6 +212,262 @@ void protocol_send_name(uint8_t port, const char* name) {
   out(EOCOMMAND);
 }
 
+void protocol_send_profiles() {
+  out(SOCOMMAND);
+  out(F("B:"));
+  out((uint8_t)PROFILE_COUNT);
+  for (uint8_t i = 0; i < PROFILE_COUNT; i++) {
+    Profile p;
+    out(':');
+    if (eeprom_profile_read(i, &p))
+      out(p.name);
+  }
+  out(EOCOMMAND);
+}
+
+void protocol_send_history(const History* h, uint32_t start) {
+  uint32_t first = history_first(h);
+  if (start > first)
+    first = start;
+  uint32_t total = h ? h->total : 0;
+  uint8_t count = 0;
+  if (first < total) {
+    uint32_t avail = total - first;
+    count = avail > HISTORY_CHUNK ? HISTORY_CHUNK : (uint8_t)avail;
+  }
+  out(SOCOMMAND);
+  out('Q');
+  out(':');
+  out(first);
+  out(':');
+  out(count);
+  out(':');
+  out(total);
+  for (uint8_t i = 0; i < count; i++) {
+    HistorySample s;
+    if (!history_get(h, first + i, &s))
+      break;
+    out(':');
+    print_centi(s.input_cv);
+    out(':');
+    print_centi(s.input_ca);
+    out(':');
+    print_centi(s.ports_ca);
+    out(':');
+    if (s.flags & HISTORY_FLAG_TEMP)
+      print_centi(s.temp_centi);
+    out(':');
+    if (s.flags & HISTORY_FLAG_TEMP)
+      print_centi(s.humid_centi);
+    out(':');
+    out(s.dew_duty);
+  }
+  out(EOCOMMAND);
+}
+
+void protocol_send_event_log(uint16_t start) {
+  uint16_t first = eventlog_first();
+  uint16_t next = eventlog_next();
+  // Sequence numbers wrap; compare offsets from the oldest record.
+  if ((uint16_t)(start - first) <= (uint16_t)(next - first)) {
+    first = start;
+  } else if ((uint16_t)(start - next) < 0x8000u) {
+    first = next;
+  }
+  uint16_t avail = (uint16_t)(next - first);
+  uint8_t count = avail > EVENTLOG_CHUNK ? EVENTLOG_CHUNK : (uint8_t)avail;
+  out(SOCOMMAND);
+  out(F("Y:LOG:"));
+  out((uint32_t)eventlog_boot());
+  out(':');
+  out((uint32_t)first);
+  out(':');
+  out(count);
+  out(':');
+  out((uint32_t)next);
+  for (uint8_t i = 0; i < count; i++) {
+    EventRecord rec;
+    if (!eventlog_get((uint16_t)(first + i), &rec))
+      break;
+    out(':');
+    out((uint32_t)rec.boot);
+    out(':');
+    out(rec.uptime_ms);
+    out(':');
+    out(rec.code);
+    out(':');
+    out(rec.arg);
+  }
+  out(EOCOMMAND);
+}
+
+void protocol_send_i2c_stats(const I2cStats* s) {
+  out(SOCOMMAND);
+  out(F("Y:I2C:"));
+  out(s->clock_hz / 1000);
+  out(':');
+  out((uint32_t)s->recoveries);
+  out(':');
+  out(s->count);
+  for (uint8_t i = 0; i < s->count; i++) {
+    const I2cAddrStats* a = &s->slot[i];
+    out(':');
+    out(a->addr);
+    out(':');
+    out((uint32_t)a->tx);
+    out(':');
+    out((uint32_t)a->nack);
+    out(':');
+    out((uint32_t)a->timeout);
+  }
+  out(EOCOMMAND);
+}
+
+void protocol_send_mcp_stats(const Mcp23017* m, uint8_t count) {
+  out(SOCOMMAND);
+  out(F("Y:MCP:"));
+  out(count);
+  for (uint8_t i = 0; i < count; i++) {
+    out(':');
+    out(m[i].addr);
+    out(':');
+    out(m[i].gpio_a);
+    out(':');
+    out(m[i].gpio_b);
+    out(':');
+    out((uint32_t)m[i].writes);
+    out(':');
+    out((uint32_t)m[i].write_fails);
+    out(':');
+    out((uint32_t)m[i].verifies);
+    out(':');
+    out((uint32_t)m[i].mismatches);
+  }
+  out(EOCOMMAND);
+}
+
+void protocol_send_eeprom_wear() {
+  out(SOCOMMAND);
+  out(F("Y:EE:"));
+  out((uint8_t)EE_REGION_COUNT);
+  for (uint8_t i = 0; i < EE_REGION_COUNT; i++) {
+    out(':');
+    out((uint32_t)eeprom_region_size(i));
+    out(':');
+    out(eeprom_wear_writes(i));
+  }
+  out(EOCOMMAND);
+}
+
+void protocol_send_task_stats(const Scheduler* s) {
+  out(SOCOMMAND);
+  out(F("Y:TASK:"));
+  out(s->count);
+  for (uint8_t i = 0; i < s->count; i++) {
+    out(':');
+    out(s->tasks[i].period_ms);
+    out(':');
+    out(scheduler_budget_us(s, i));
+    out(':');
+    out((uint32_t)s->tasks[i].overruns);
+    out(':');
+    out((uint32_t)s->tasks[i].late);
+  }
+  out(EOCOMMAND);
+}
+
+void protocol_send_stack() {
+  out(SOCOMMAND);
+  out(F("Y:STACK:"));
+  out((uint32_t)stack_static_bytes());
+  out(':');
+  out((uint32_t)stack_free_bytes());
+  out(':');
+  out((uint32_t)stack_min_free_bytes());
+  out(EOCOMMAND);
+}
+
+#if TIMING_STATS
+namespace {
+void send_timing_stat(const TimingStat* t) {
+  out(':');
+  out(t->count);
+  out(':');
+  out(t->min_us);
+  out(':');
+  out(t->count ? t->total_us / t->count : (uint32_t)0);
+  out(':');
+  out(t->max_us);
+}
+} // namespace
+
+void protocol_send_timing(const Scheduler* s) {
+  out(SOCOMMAND);
+  out(F("Y:TIME:"));
+  out((uint8_t)TIME_SECTION_COUNT);
+  out(':');
+  out(s->count);
+  for (uint8_t i = 0; i < TIME_SECTION_COUNT; i++)
+    send_timing_stat(timing_section(i));
+  for (uint8_t i = 0; i < s->count; i++)
+    send_timing_stat(&s->tasks[i].time);
+  out(EOCOMMAND);
+}
+
+void protocol_send_loop_histogram() {
+  out(SOCOMMAND);
+  out(F("Y:TIME:LOOP:"));
+  out((uint32_t)TIMING_LOOP_BIN0_US);
+  out(':');
+  out((uint8_t)TIMING_LOOP_BINS);
+  for (uint8_t i = 0; i < TIMING_LOOP_BINS; i++) {
+    out(':');
+    out(timing_loop_bin(i));
+  }
+  out(EOCOMMAND);
+}
+#endif
+
+void protocol_send_dew_curve(const DewCurveSettings* s) {
+  out(SOCOMMAND);
+  out('U');
+  out(':');
+  out(s->type);
+  for (uint8_t i = 0; i < DEW_CURVE_POINTS; i++) {
+    out(':');
+    out((int32_t)s->points[i].margin_centi);
+    out(':');
+    out(s->points[i].duty_pct);
+  }
+  out(EOCOMMAND);
+}
+
+void protocol_send_port_dew(uint8_t port, const DewPortConfig* dew, const Ports* ports,
+                            uint8_t pwm_index) {
+  out(SOCOMMAND);
+  out('A');
+  out(':');
+  if (port < 10)
+    out('0');
+  out(port);
+  out(':');
+  out((int32_t)(dew->m_on_centi / 100));
+  out(':');
+  out(dew->duty_min_pct);
+  out(':');
+  out(dew->duty_max_pct);
+  out(':');
+  out(dew->slew_pct);
+  out(':');
+  out((uint8_t)(ports->dew_active[pwm_index] ? 1 : 0));
+  out(':');
+  out((uint32_t)ports->dew_duty[pwm_index]);
+  out(':');
+  if (ports->strap_mask & (1u << pwm_index))
+    print_centi(ports->strap_centi[pwm_index]);
+  out(EOCOMMAND);
+}
+
 void protocol_send_mcp_dump(uint8_t addr, bool probe_ok, bool read_a_ok, bool read_b_ok,
                             uint8_t cached_a, uint8_t cached_b, uint8_t gpio_a,
                             uint8_t gpio_b) {
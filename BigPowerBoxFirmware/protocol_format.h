@@ -2,15 +2,40 @@
 
 #include <Arduino.h>
 
+#include "dew_curve.h"
+#include "history.h"
+#include "i2c_bus.h"
 #include "ports.h"
+#include "probes.h"
+#include "scheduler.h"
+#include "trend.h"
 
 void protocol_send_ok(const __FlashStringHelper* tag);
 void protocol_send_err();
 void protocol_send_status(const Ports* ports);
+void protocol_send_extended_status(const Ports* ports, const Trend* trend);
 void protocol_send_discovery();
+void protocol_send_ambient_probes(const Probes* p);
+void protocol_send_sample_interval(uint16_t min_ms, uint16_t max_ms, uint16_t current_ms);
 void protocol_send_pwm_mode(uint8_t port, uint8_t mode);
-void protocol_send_dew_margin(uint8_t port);
+void protocol_send_ramp_rate(uint8_t port, uint8_t pct_s);
+void protocol_send_dew_margin(uint8_t port, int16_t m_on_centi);
 void protocol_send_name(uint8_t port, const char* name);
+void protocol_send_profiles();
+void protocol_send_history(const History* h, uint32_t start);
+void protocol_send_event_log(uint16_t start);
+void protocol_send_i2c_stats(const I2cStats* s);
+void protocol_send_mcp_stats(const Mcp23017* m, uint8_t count);
+void protocol_send_eeprom_wear();
+void protocol_send_task_stats(const Scheduler* s);
+void protocol_send_stack();
+#if TIMING_STATS
+void protocol_send_timing(const Scheduler* s);
+void protocol_send_loop_histogram();
+#endif
+void protocol_send_dew_curve(const DewCurveSettings* s);
+void protocol_send_port_dew(uint8_t port, const DewPortConfig* dew, const Ports* ports,
+                            uint8_t pwm_index);
 void protocol_send_mcp_dump(uint8_t addr, bool probe_ok, bool read_a_ok, bool read_b_ok,
                             uint8_t cached_a, uint8_t cached_b, uint8_t gpio_a,
                             uint8_t gpio_b);
\ No newline at end of file
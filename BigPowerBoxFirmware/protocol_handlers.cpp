@@ -5,12 +5,21 @@
 #include <string.h>
 
 #include "board_config.h"
+#include "dew_curve.h"
 #include "eeprom_cfg.h"
-#ifdef DEBUG
+#include "eeprom_names.h"
+#include "eeprom_wear.h"
+#include "eventlog.h"
+#include "history.h"
 #include "i2c_bus.h"
+#include "probes.h"
+#include "scheduler.h"
+#include "timing.h"
+#ifdef DEBUG
 #include "mcp23017.h"
 #endif
 #include "protocol_format.h"
+#include "trend.h"
 
 namespace {
 uint8_t parse_port(const char* s, bool* ok) {
@@ -39,26 +48,23 @@ int16_t parse_int16(const char* s, bool* ok) {
   return (int16_t)v;
 }
 
-// Map a physical port index to the compact PWM port index used in config.
-int8_t pwm_index_for_port(uint8_t port) {
-  uint8_t count = 0;
-  for (uint8_t i = 0; i < PORT_COUNT; i++) {
-    if (ports_port_type(i) == 'p') {
-      if (i == port)
-        return (int8_t)count;
-      count++;
-    }
+uint32_t parse_uint32(const char* s, bool* ok) {
+  if (!s || !ok)
+    return 0;
+  char* end = nullptr;
+  unsigned long v = strtoul(s, &end, 10);
+  if (end == s || s[0] == '-') {
+    *ok = false;
+    return 0;
   }
-  return -1;
+  *ok = true;
+  return (uint32_t)v;
 }
 
 // Persist on/off state for all ports to EEPROM config.
 void save_port_status_config(const Ports* ports) {
-  g_config.portStatus = 0;
-  for (uint8_t i = 0; i < PORT_COUNT; i++) {
-    if (ports_port_type(i) == 'a' || ports_get(ports, i))
-      g_config.portStatus |= (1u << i);
-  }
+  g_config.portStatus = ports->state;
+  board_set_always_on(&g_config.portStatus);
   eeprom_cfg_save(&g_config);
 }
 
@@ -74,6 +80,10 @@ void handle_status(const Ports* ports) {
   protocol_send_status(ports);
 }
 
+void handle_extended_status(const Ports* ports) {
+  protocol_send_extended_status(ports, &g_trend);
+}
+
 void handle_port_on(char* const* argv, uint8_t argc, Ports* ports) {
   if (argc < 2) {
     protocol_send_err();
@@ -85,7 +95,7 @@ void handle_port_on(char* const* argv, uint8_t argc, Ports* ports) {
   }
   bool ok = false;
   uint8_t port = parse_port(argv[1], &ok);
-  char type = ports_port_type(port);
+  char type = board_port_type(port);
   if (!ok || !ports_is_controllable(port)) {
     protocol_send_err();
     return;
@@ -109,7 +119,7 @@ void handle_port_off(char* const* argv, uint8_t argc, Ports* ports) {
   }
   bool ok = false;
   uint8_t port = parse_port(argv[1], &ok);
-  char type = ports_port_type(port);
+  char type = board_port_type(port);
   if (!ok || !ports_is_controllable(port)) {
     protocol_send_err();
     return;
@@ -133,7 +143,7 @@ void handle_pwm_level(char* const* argv, uint8_t argc, Ports* ports) {
   }
   bool ok = false;
   uint8_t port = parse_port(argv[1], &ok);
-  if (!ok || ports_port_type(port) != 'p') {
+  if (!ok || board_port_type(port) != 'p') {
     protocol_send_err();
     return;
   }
@@ -142,12 +152,19 @@ void handle_pwm_level(char* const* argv, uint8_t argc, Ports* ports) {
     protocol_send_err();
     return;
   }
+  // Levels are 0..255 unless a full-scale value follows, e.g. `W:09:100:1023`.
   bool ok_level = false;
-  uint8_t level = parse_port(argv[2], &ok_level);
-  if (!ok_level) {
+  uint32_t raw = parse_uint32(argv[2], &ok_level);
+  uint32_t scale = 255;
+  if (ok_level && argc >= 4)
+    scale = parse_uint32(argv[3], &ok_level);
+  if (!ok_level || scale == 0 || scale > 0xFFFFu || raw > scale) {
     protocol_send_err();
     return;
   }
+  uint16_t level = (uint16_t)((raw * PWM_LEVEL_MAX + scale / 2) / scale);
+  if (raw > 0 && level == 0)
+    level = 1;
   if (level > 0 && ports_overvoltage(ports)) {
     protocol_send_err();
     return;
@@ -156,8 +173,9 @@ void handle_pwm_level(char* const* argv, uint8_t argc, Ports* ports) {
     protocol_send_err();
     return;
   }
-  int8_t pwm_index = pwm_index_for_port(port);
-  if (pwm_index >= 0) {
+  // A ramping level is saved by the main loop once it is reached.
+  int8_t pwm_index = board_pwm_index(port);
+  if (pwm_index >= 0 && !ports_ramping(ports, (uint8_t)pwm_index)) {
     g_config.pwmPorts[pwm_index] = level;
     eeprom_cfg_save(&g_config);
   }
@@ -171,7 +189,7 @@ void handle_pwm_mode(char* const* argv, uint8_t argc, Ports* ports) {
   }
   bool ok = false;
   uint8_t port = parse_port(argv[1], &ok);
-  if (!ok || ports_port_type(port) != 'p') {
+  if (!ok || board_port_type(port) != 'p') {
     protocol_send_err();
     return;
   }
@@ -181,7 +199,7 @@ void handle_pwm_mode(char* const* argv, uint8_t argc, Ports* ports) {
     protocol_send_err();
     return;
   }
-  if (mode == PWM_MODE_DEW_AMBIENT && !ports->have_temp) {
+  if (ports_is_dew_mode(mode) && !ports->have_temp) {
     protocol_send_err();
     return;
   }
@@ -189,7 +207,7 @@ void handle_pwm_mode(char* const* argv, uint8_t argc, Ports* ports) {
     protocol_send_err();
     return;
   }
-  int8_t pwm_index = pwm_index_for_port(port);
+  int8_t pwm_index = board_pwm_index(port);
   if (pwm_index >= 0) {
     g_config.pwmPortMode[pwm_index] = mode;
     eeprom_cfg_save(&g_config);
@@ -204,7 +222,7 @@ void handle_set_name(char* const* argv, uint8_t argc) {
   }
   bool ok = false;
   uint8_t port = parse_port(argv[1], &ok);
-  if (!ok) {
+  if (!ok || port >= PORT_COUNT) {
     protocol_send_err();
     return;
   }
@@ -219,7 +237,7 @@ void handle_get_name(char* const* argv, uint8_t argc) {
   }
   bool ok = false;
   uint8_t port = parse_port(argv[1], &ok);
-  if (!ok) {
+  if (!ok || port >= PORT_COUNT) {
     protocol_send_err();
     return;
   }
@@ -245,49 +263,296 @@ void handle_legacy_dew_margin(char* const* argv, uint8_t argc) {
     protocol_send_err();
     return;
   }
-  protocol_send_dew_margin(port);
+  int8_t pwm_index = board_pwm_index(port);
+  protocol_send_dew_margin(port, g_config.dew[pwm_index >= 0 ? pwm_index : 0].m_on_centi);
 }
 
+// Parse `<deg>[:<min>[:<max>[:<slew>]]]` starting at argv[first] on top of the
+// current settings in *dew.
+bool parse_dew_settings(char* const* argv, uint8_t argc, uint8_t first, DewPortConfig* dew) {
+  bool ok_on = false;
+  int16_t dew_on_deg = parse_int16(argv[first], &ok_on);
+  if (!ok_on || dew_on_deg < 0 || dew_on_deg > 5)
+    return false;
+  uint8_t duty_min_pct = dew->duty_min_pct;
+  uint8_t duty_max_pct = dew->duty_max_pct;
+  uint8_t slew_pct = dew->slew_pct;
+  if (argc > first + 1) {
+    bool ok_min = false;
+    duty_min_pct = parse_port(argv[first + 1], &ok_min);
+    if (!ok_min || duty_min_pct > 100)
+      return false;
+  }
+  if (argc > first + 2) {
+    bool ok_max = false;
+    duty_max_pct = parse_port(argv[first + 2], &ok_max);
+    if (!ok_max || duty_max_pct > 100)
+      return false;
+  }
+  if (argc > first + 3) {
+    bool ok_slew = false;
+    slew_pct = parse_port(argv[first + 3], &ok_slew);
+    // Rates below the 5 % output step are fine: the slew accumulates on the
+    // unrounded duty (dew_curve_slew). 0 would freeze the port.
+    if (!ok_slew || slew_pct == 0 || slew_pct > 100)
+      return false;
+  }
+  if (duty_min_pct > duty_max_pct)
+    return false;
+  dew->m_on_centi = (int16_t)(dew_on_deg * 100);
+  dew->duty_min_pct = duty_min_pct;
+  dew->duty_max_pct = duty_max_pct;
+  dew->slew_pct = slew_pct;
+  return true;
+}
+
+// K applies the same settings to every PWM port.
 void handle_dew_config(char* const* argv, uint8_t argc) {
   if (argc < 2 || argc > 4) {
     protocol_send_err();
     return;
   }
-  bool ok_on = false;
-  int16_t dew_on_deg = parse_int16(argv[1], &ok_on);
-  if (!ok_on || dew_on_deg < 0 || dew_on_deg > 5) {
+  DewPortConfig dew = g_config.dew[0];
+  if (!parse_dew_settings(argv, argc, 1, &dew)) {
     protocol_send_err();
     return;
   }
+  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+    g_config.dew[i].m_on_centi = dew.m_on_centi;
+    g_config.dew[i].duty_min_pct = dew.duty_min_pct;
+    g_config.dew[i].duty_max_pct = dew.duty_max_pct;
+  }
+  eeprom_cfg_save(&g_config);
+  dew_curve_build_all(g_dew_curves, &g_dew_curve_settings, &g_config);
+  protocol_send_ok(F("KOK"));
+}
 
-  uint8_t duty_min_pct = g_config.dew_duty_min_pct;
-  uint8_t duty_max_pct = g_config.dew_duty_max_auto_pct;
-  if (argc >= 3) {
-    bool ok_min = false;
-    duty_min_pct = parse_port(argv[2], &ok_min);
-    if (!ok_min || duty_min_pct > 100) {
+void handle_port_dew_config(char* const* argv, uint8_t argc, const Ports* ports) {
+  if (argc < 2) {
+    protocol_send_err();
+    return;
+  }
+  bool ok = false;
+  uint8_t port = parse_port(argv[1], &ok);
+  if (!ok || board_port_type(port) != 'p') {
+    protocol_send_err();
+    return;
+  }
+  int8_t pwm_index = board_pwm_index(port);
+  if (pwm_index < 0) {
+    protocol_send_err();
+    return;
+  }
+  if (argc == 2) {
+    protocol_send_port_dew(port, &g_config.dew[pwm_index], ports, (uint8_t)pwm_index);
+    return;
+  }
+  DewPortConfig dew = g_config.dew[pwm_index];
+  if (!parse_dew_settings(argv, argc, 2, &dew)) {
+    protocol_send_err();
+    return;
+  }
+  g_config.dew[pwm_index] = dew;
+  eeprom_cfg_save(&g_config);
+  dew_curve_build(&g_dew_curves[pwm_index], &g_dew_curve_settings, &dew);
+  protocol_send_ok(F("AOK"));
+}
+
+void handle_dew_curve(char* const* argv, uint8_t argc) {
+  if (argc == 1) {
+    protocol_send_dew_curve(&g_dew_curve_settings);
+    return;
+  }
+  if (argc == 2) {
+    bool ok = false;
+    uint8_t type = parse_port(argv[1], &ok);
+    if (!ok || type > DEW_CURVE_USER) {
+      protocol_send_err();
+      return;
+    }
+    g_dew_curve_settings.type = type;
+  } else if (argc == 4) {
+    bool ok_i = false;
+    bool ok_m = false;
+    bool ok_d = false;
+    uint8_t idx = parse_port(argv[1], &ok_i);
+    int16_t margin = parse_int16(argv[2], &ok_m);
+    uint8_t duty_pct = parse_port(argv[3], &ok_d);
+    if (!ok_i || !ok_m || !ok_d || idx >= DEW_CURVE_POINTS || margin < 0 ||
+        margin > (DEW_CURVE_ENTRIES - 1) * DEW_CURVE_STEP_CENTI || duty_pct > 100) {
       protocol_send_err();
       return;
     }
+    g_dew_curve_settings.points[idx].margin_centi = margin;
+    g_dew_curve_settings.points[idx].duty_pct = duty_pct;
+  } else {
+    protocol_send_err();
+    return;
   }
-  if (argc >= 4) {
-    bool ok_max = false;
-    duty_max_pct = parse_port(argv[3], &ok_max);
-    if (!ok_max || duty_max_pct > 100) {
+  dew_curve_save(&g_dew_curve_settings);
+  dew_curve_build_all(g_dew_curves, &g_dew_curve_settings, &g_config);
+  protocol_send_ok(F("UOK"));
+}
+
+void handle_history(char* const* argv, uint8_t argc) {
+  uint32_t start = 0;
+  if (argc >= 2) {
+    bool ok = false;
+    start = parse_uint32(argv[1], &ok);
+    if (!ok) {
       protocol_send_err();
       return;
     }
   }
-  if (duty_min_pct > duty_max_pct) {
+  protocol_send_history(&g_history, start);
+}
+
+void handle_sample_interval(char* const* argv, uint8_t argc, Ports* ports) {
+  if (argc < 2) {
+    protocol_send_sample_interval(g_config.sample_min_ms, g_config.sample_max_ms,
+                                  ports->sample_interval_ms);
+    return;
+  }
+  if (argc < 3) {
+    protocol_send_err();
+    return;
+  }
+  bool ok_min = false;
+  bool ok_max = false;
+  uint32_t lo = parse_uint32(argv[1], &ok_min);
+  uint32_t hi = parse_uint32(argv[2], &ok_max);
+  if (!ok_min || !ok_max || lo < SENSOR_INTERVAL_FLOOR_MS || hi > SENSOR_INTERVAL_CEIL_MS || lo > hi) {
     protocol_send_err();
     return;
   }
+  g_config.sample_min_ms = (uint16_t)lo;
+  g_config.sample_max_ms = (uint16_t)hi;
+  eeprom_cfg_save(&g_config);
+  // Pick up the new bounds now; the next dew update recomputes the interval.
+  if (ports->sample_interval_ms < lo)
+    ports->sample_interval_ms = (uint16_t)lo;
+  if (ports->sample_interval_ms > hi)
+    ports->sample_interval_ms = (uint16_t)hi;
+  protocol_send_ok(F("IOK"));
+}
 
-  g_config.dew_m_on_centi = (int16_t)(dew_on_deg * 100);
-  g_config.dew_duty_min_pct = duty_min_pct;
-  g_config.dew_duty_max_auto_pct = duty_max_pct;
+void handle_ambient_probes(char* const* argv, uint8_t argc) {
+  if (argc < 2) {
+    protocol_send_ambient_probes(&g_probes);
+    return;
+  }
+  bool ok = false;
+  uint32_t fusion = parse_uint32(argv[1], &ok);
+  if (!ok || fusion > FUSION_AVERAGE) {
+    protocol_send_err();
+    return;
+  }
+  uint32_t primary = g_config.ambient_primary;
+  if (argc >= 3) {
+    primary = parse_uint32(argv[2], &ok);
+    if (!ok || primary > 0x7F) {
+      protocol_send_err();
+      return;
+    }
+  }
+  g_config.ambient_fusion = (uint8_t)fusion;
+  g_config.ambient_primary = (uint8_t)primary;
   eeprom_cfg_save(&g_config);
-  protocol_send_ok(F("KOK"));
+  g_probes.fusion = g_config.ambient_fusion;
+  g_probes.primary_addr = g_config.ambient_primary;
+  protocol_send_ok(F("EOK"));
+}
+
+void handle_event_log(char* const* argv, uint8_t argc) {
+  if (argc >= 3 && strcmp(argv[2], "CLR") == 0) {
+    eventlog_clear();
+    protocol_send_ok(F("YOK"));
+    return;
+  }
+  uint16_t start = eventlog_first();
+  if (argc >= 3) {
+    bool ok = false;
+    uint32_t v = parse_uint32(argv[2], &ok);
+    if (!ok || v > 0xFFFFu) {
+      protocol_send_err();
+      return;
+    }
+    start = (uint16_t)v;
+  }
+  protocol_send_event_log(start);
+}
+
+void handle_i2c_stats(char* const* argv, uint8_t argc) {
+  if (argc >= 3 && strcmp(argv[2], "CLR") == 0) {
+    i2c_clear_stats();
+    protocol_send_ok(F("YOK"));
+    return;
+  }
+  protocol_send_i2c_stats(i2c_stats());
+}
+
+void handle_mcp_stats(char* const* argv, uint8_t argc, Ports* ports) {
+  if (argc >= 3 && strcmp(argv[2], "CLR") == 0) {
+    for (uint8_t i = 0; i < MCP23017_COUNT; i++)
+      mcp23017_clear_stats(&ports->mcp[i]);
+    protocol_send_ok(F("YOK"));
+    return;
+  }
+  protocol_send_mcp_stats(ports->mcp, MCP23017_COUNT);
+}
+
+void handle_task_stats(char* const* argv, uint8_t argc) {
+  if (argc >= 3 && strcmp(argv[2], "CLR") == 0) {
+    scheduler_clear_stats(&g_scheduler);
+    protocol_send_ok(F("YOK"));
+    return;
+  }
+  protocol_send_task_stats(&g_scheduler);
+}
+
+void handle_timing(char* const* argv, uint8_t argc) {
+#if TIMING_STATS
+  if (argc >= 3 && strcmp(argv[2], "CLR") == 0) {
+    timing_reset();
+    scheduler_clear_timing(&g_scheduler);
+    protocol_send_ok(F("YOK"));
+    return;
+  }
+  if (argc >= 3 && strcmp(argv[2], "LOOP") == 0) {
+    protocol_send_loop_histogram();
+    return;
+  }
+  protocol_send_timing(&g_scheduler);
+#else
+  // Built without TIMING_STATS: there is nothing to report.
+  (void)argv;
+  (void)argc;
+  protocol_send_err();
+#endif
+}
+
+void handle_diagnostics(char* const* argv, uint8_t argc, Ports* ports) {
+  if (argc < 2 || !argv[1] || !ports) {
+    protocol_send_err();
+    return;
+  }
+  if (strcmp(argv[1], "LOG") == 0) {
+    handle_event_log(argv, argc);
+  } else if (strcmp(argv[1], "I2C") == 0) {
+    handle_i2c_stats(argv, argc);
+  } else if (strcmp(argv[1], "MCP") == 0) {
+    handle_mcp_stats(argv, argc, ports);
+  } else if (strcmp(argv[1], "EE") == 0) {
+    protocol_send_eeprom_wear();
+  } else if (strcmp(argv[1], "TASK") == 0) {
+    handle_task_stats(argv, argc);
+  } else if (strcmp(argv[1], "STACK") == 0) {
+    protocol_send_stack();
+  } else if (strcmp(argv[1], "TIME") == 0) {
+    handle_timing(argv, argc);
+  } else {
+    protocol_send_err();
+  }
 }
 
 void reset_port_names() {
@@ -301,7 +566,18 @@ void reset_port_names() {
 void reset_config_and_ports(Ports* ports) {
   ports_all_off(ports);
   eeprom_cfg_defaults(&g_config);
+  // A reset is expected to stick even if power goes right after the reply.
   eeprom_cfg_save(&g_config);
+  dew_curve_defaults(&g_dew_curve_settings);
+  dew_curve_save(&g_dew_curve_settings);
+  eeprom_cfg_flush();
+  dew_curve_build_all(g_dew_curves, &g_dew_curve_settings, &g_config);
+  ports->sample_interval_ms = g_config.sample_min_ms;
+  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+    ports->ramp_pct_s[i] = g_config.ramp_pct_s[i];
+  }
+  g_probes.fusion = g_config.ambient_fusion;
+  g_probes.primary_addr = g_config.ambient_primary;
 }
 
 void handle_reset(char* const* argv, uint8_t argc, Ports* ports) {
@@ -320,9 +596,100 @@ void handle_reset(char* const* argv, uint8_t argc, Ports* ports) {
     protocol_send_err();
     return;
   }
+  eeprom_wear_flush();
   protocol_send_ok(F("ROK"));
 }
 
+// Applies a profile to the outputs and config as one update: expander pins
+// go out in the next flush and the config is written once.
+void recall_profile(const Profile* p, Ports* ports) {
+  g_config.portStatus = p->portStatus;
+  board_set_always_on(&g_config.portStatus);
+  for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+    g_config.pwmPorts[i] = p->pwmPorts[i];
+    g_config.pwmPortMode[i] = p->pwmPortMode[i];
+    g_config.dew[i] = p->dew[i];
+  }
+  dew_curve_build_all(g_dew_curves, &g_dew_curve_settings, &g_config);
+  ports_load(ports, &g_config.portStatus, g_config.pwmPorts, g_config.pwmPortMode);
+  ports_apply_config(ports);
+  if (!ports->have_temp)
+    ports_suspend_dew_mode(ports);
+  eeprom_cfg_save(&g_config);
+}
+
+// B lists the profiles; B:S:<slot>:<name> saves, B:L:<slot> recalls and
+// B:D:<slot> deletes one.
+void handle_profile(char* const* argv, uint8_t argc, Ports* ports) {
+  if (argc < 2) {
+    protocol_send_profiles();
+    return;
+  }
+  bool ok = false;
+  uint8_t slot = argc >= 3 ? parse_port(argv[2], &ok) : 0;
+  if (!ok || slot >= PROFILE_COUNT) {
+    protocol_send_err();
+    return;
+  }
+  Profile p;
+  if (strcmp(argv[1], "S") == 0) {
+    if (argc < 4 || argv[3][0] == '\0') {
+      protocol_send_err();
+      return;
+    }
+    memset(&p, 0, sizeof(p));
+    strncpy(p.name, argv[3], PROFILE_NAME_LENGTH - 1);
+    p.portStatus = g_config.portStatus;
+    for (uint8_t i = 0; i < PWM_PORT_COUNT; i++) {
+      p.pwmPorts[i] = g_config.pwmPorts[i];
+      p.pwmPortMode[i] = g_config.pwmPortMode[i];
+      p.dew[i] = g_config.dew[i];
+    }
+    eeprom_profile_write(slot, &p);
+  } else if (strcmp(argv[1], "L") == 0) {
+    // Outputs stay off until the input voltage is back in range.
+    if (ports_overvoltage(ports) || !eeprom_profile_read(slot, &p)) {
+      protocol_send_err();
+      return;
+    }
+    recall_profile(&p, ports);
+  } else if (strcmp(argv[1], "D") == 0) {
+    eeprom_profile_erase(slot);
+  } else {
+    protocol_send_err();
+    return;
+  }
+  protocol_send_ok(F("BOK"));
+}
+
+void handle_ramp_rate(char* const* argv, uint8_t argc, Ports* ports) {
+  if (argc < 2) {
+    protocol_send_err();
+    return;
+  }
+  bool ok = false;
+  uint8_t port = parse_port(argv[1], &ok);
+  int8_t pwm_index = ok ? board_pwm_index(port) : -1;
+  if (pwm_index < 0) {
+    protocol_send_err();
+    return;
+  }
+  if (argc < 3) {
+    protocol_send_ramp_rate(port, ports->ramp_pct_s[pwm_index]);
+    return;
+  }
+  bool ok_rate = false;
+  uint8_t rate = parse_port(argv[2], &ok_rate);
+  if (!ok_rate || rate > 100) {
+    protocol_send_err();
+    return;
+  }
+  ports->ramp_pct_s[pwm_index] = rate;
+  g_config.ramp_pct_s[pwm_index] = rate;
+  eeprom_cfg_save(&g_config);
+  protocol_send_ok(F("ZOK"));
+}
+
 void handle_get_pwm_mode(char* const* argv, uint8_t argc, Ports* ports) {
   if (argc < 2) {
     protocol_send_err();
@@ -330,7 +697,7 @@ void handle_get_pwm_mode(char* const* argv, uint8_t argc, Ports* ports) {
   }
   bool ok = false;
   uint8_t port = parse_port(argv[1], &ok);
-  if (!ok || ports_port_type(port) != 'p') {
+  if (!ok || board_port_type(port) != 'p') {
     protocol_send_err();
     return;
   }
@@ -354,18 +721,28 @@ void handle_olen(char* const* argv, uint8_t argc) {
   protocol_send_ok(F("LOK"));
 }
 
-void handle_mcp_dump(Ports* ports) {
+void handle_mcp_dump(char* const* argv, uint8_t argc, Ports* ports) {
   if (!ports) {
     protocol_send_err();
     return;
   }
+  uint8_t index = 0;
+  if (argc >= 2) {
+    bool ok = false;
+    index = parse_port(argv[1], &ok);
+    if (!ok || index >= MCP23017_COUNT) {
+      protocol_send_err();
+      return;
+    }
+  }
+  Mcp23017* m = &ports->mcp[index];
   uint8_t gpio_a = 0;
   uint8_t gpio_b = 0;
-  bool probe_ok = i2c_probe(ports->mcp.addr);
-  bool read_a_ok = mcp23017_read_gpioa(&ports->mcp, &gpio_a);
-  bool read_b_ok = mcp23017_read_gpiob(&ports->mcp, &gpio_b);
-  protocol_send_mcp_dump(ports->mcp.addr, probe_ok, read_a_ok, read_b_ok, ports->mcp.gpio_a,
-                         ports->mcp.gpio_b, gpio_a, gpio_b);
+  bool probe_ok = i2c_probe(m->addr);
+  bool read_a_ok = mcp23017_read_gpioa(m, &gpio_a);
+  bool read_b_ok = mcp23017_read_gpiob(m, &gpio_b);
+  protocol_send_mcp_dump(m->addr, probe_ok, read_a_ok, read_b_ok, m->gpio_a, m->gpio_b, gpio_a,
+                         gpio_b);
 }
 #endif
 
@@ -415,6 +792,12 @@ void protocol_handle_command(char command, char* const* argv, uint8_t argc, Port
   case 'S':
     handle_status(ports);
     break;
+  case 'V':
+    handle_extended_status(ports);
+    break;
+  case 'E':
+    handle_ambient_probes(argv, argc);
+    break;
   case 'O':
     handle_port_on(argv, argc, ports);
     break;
@@ -442,18 +825,39 @@ void protocol_handle_command(char command, char* const* argv, uint8_t argc, Port
   case 'K':
     handle_dew_config(argv, argc);
     break;
+  case 'A':
+    handle_port_dew_config(argv, argc, ports);
+    break;
+  case 'Q':
+    handle_history(argv, argc);
+    break;
+  case 'I':
+    handle_sample_interval(argv, argc, ports);
+    break;
+  case 'U':
+    handle_dew_curve(argv, argc);
+    break;
   case 'R':
     handle_reset(argv, argc, ports);
     break;
+  case 'B':
+    handle_profile(argv, argc, ports);
+    break;
   case 'G':
     handle_get_pwm_mode(argv, argc, ports);
     break;
+  case 'Z':
+    handle_ramp_rate(argv, argc, ports);
+    break;
+  case 'Y':
+    handle_diagnostics(argv, argc, ports);
+    break;
 #ifdef DEBUG
   case 'L':
     handle_olen(argv, argc);
     break;
   case 'J':
-    handle_mcp_dump(ports);
+    handle_mcp_dump(argv, argc, ports);
     break;
 #endif
 #ifdef DEBUG
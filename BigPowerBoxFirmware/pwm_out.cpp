@@ -0,0 +1,158 @@
+#include "pwm_out.h"
+
+static_assert(PWM_PERIOD_TICKS <= 65535u, "PWM period must fit Timer1");
+static_assert(PWM_PERIOD_TICKS / PWM_LEVEL_MAX > PWM_EDGE_SLACK_TICKS,
+              "PWM steps must be longer than the edge slack");
+
+namespace {
+constexpr uint16_t NO_CARRY = 0xFFFF;
+
+struct Edge {
+  uint16_t tick;
+  uint8_t channel;
+  bool on;
+};
+
+volatile uint8_t* s_out[PWM_PORT_COUNT];
+uint8_t s_mask[PWM_PORT_COUNT];
+// On-time in timer ticks, written by pwm_out_set() and latched each period.
+volatile uint16_t s_on_ticks[PWM_PORT_COUNT];
+// Switch-off tick for pulses that run past the end of the previous period.
+uint16_t s_carry[PWM_PORT_COUNT];
+// A channel adds at most three edges per period: the end of a pulse carried
+// over from the last period, then its own rise and fall.
+constexpr uint8_t EDGES_PER_CHANNEL = 3;
+constexpr uint8_t EDGE_CAPACITY = EDGES_PER_CHANNEL * PWM_PORT_COUNT;
+static_assert(EDGES_PER_CHANNEL * PWM_PORT_COUNT <= 255, "edge count must fit uint8_t");
+// Edges of the current period, sorted by tick.
+Edge s_edges[EDGE_CAPACITY];
+static_assert(sizeof(s_edges) / sizeof(s_edges[0]) >= EDGES_PER_CHANNEL * PWM_PORT_COUNT,
+              "edge buffer must hold the worst-case period");
+uint8_t s_edge_count;
+uint8_t s_edge_next;
+
+inline void pin_write(uint8_t ch, bool on) {
+  if (!s_out[ch])
+    return;
+  if (on)
+    *s_out[ch] |= s_mask[ch];
+  else
+    *s_out[ch] &= (uint8_t)~s_mask[ch];
+}
+
+void add_edge(uint16_t tick, uint8_t ch, bool on) {
+  if (s_edge_count >= EDGE_CAPACITY)
+    return;
+  uint8_t j = s_edge_count++;
+  while (j > 0 && s_edges[j - 1].tick > tick) {
+    s_edges[j] = s_edges[j - 1];
+    j--;
+  }
+  s_edges[j].tick = tick;
+  s_edges[j].channel = ch;
+  s_edges[j].on = on;
+}
+
+// Apply every edge that is due (or nearly due) and arm the compare interrupt
+// for the next one.
+void run_due_edges() {
+  while (s_edge_next < s_edge_count) {
+    const Edge& e = s_edges[s_edge_next];
+    if (e.tick > TCNT1 + PWM_EDGE_SLACK_TICKS) {
+      OCR1A = e.tick;
+      TIFR1 = _BV(OCF1A);
+      // Catch a counter that moved past the compare value while arming.
+      if (TCNT1 < e.tick) {
+        TIMSK1 |= _BV(OCIE1A);
+        return;
+      }
+      continue;
+    }
+    pin_write(e.channel, e.on);
+    s_edge_next++;
+  }
+  TIMSK1 &= (uint8_t)~_BV(OCIE1A);
+}
+} // namespace
+
+// Timer1 reached TOP: start a new period from the latest on-times.
+ISR(TIMER1_CAPT_vect) {
+  // The flag is raised one tick before the counter wraps.
+  while (TCNT1 > PWM_PERIOD_TICKS / 2) {
+  }
+  s_edge_count = 0;
+  s_edge_next = 0;
+  for (uint8_t ch = 0; ch < PWM_PORT_COUNT; ch++) {
+    uint16_t on = s_on_ticks[ch];
+    uint16_t carry = s_carry[ch];
+    s_carry[ch] = NO_CARRY;
+    if (on >= PWM_PERIOD_TICKS) {
+      pin_write(ch, true);
+      continue;
+    }
+    if (carry == NO_CARRY)
+      pin_write(ch, false);
+    else
+      add_edge(carry, ch, false);
+    if (on == 0)
+      continue;
+    uint16_t rise = (uint16_t)((uint32_t)PWM_PERIOD_TICKS * ch / PWM_PORT_COUNT);
+    uint32_t fall = (uint32_t)rise + on;
+    add_edge(rise, ch, true);
+    if (fall < PWM_PERIOD_TICKS)
+      add_edge((uint16_t)fall, ch, false);
+    else
+      s_carry[ch] = (uint16_t)(fall - PWM_PERIOD_TICKS);
+  }
+  run_due_edges();
+}
+
+ISR(TIMER1_COMPA_vect) {
+  run_due_edges();
+}
+
+void pwm_out_attach(uint8_t channel, uint8_t pin) {
+  if (channel >= PWM_PORT_COUNT)
+    return;
+  pinMode(pin, OUTPUT);
+  digitalWrite(pin, LOW);
+  s_out[channel] = portOutputRegister(digitalPinToPort(pin));
+  s_mask[channel] = digitalPinToBitMask(pin);
+  s_on_ticks[channel] = 0;
+  s_carry[channel] = NO_CARRY;
+}
+
+void pwm_out_begin() {
+  noInterrupts();
+  // CTC with TOP = ICR1 at clk/8; OC1A/OC1B stay disconnected (pin 10 is MUX0).
+  TCCR1A = 0;
+  TCCR1B = _BV(WGM13) | _BV(WGM12) | _BV(CS11);
+  ICR1 = PWM_PERIOD_TICKS - 1;
+  TCNT1 = 0;
+  s_edge_count = 0;
+  s_edge_next = 0;
+  TIFR1 = _BV(ICF1) | _BV(OCF1A);
+  TIMSK1 = _BV(ICIE1);
+  interrupts();
+}
+
+void pwm_out_set(uint8_t channel, uint16_t level) {
+  if (channel >= PWM_PORT_COUNT)
+    return;
+  if (level > PWM_LEVEL_MAX)
+    level = PWM_LEVEL_MAX;
+  uint16_t ticks = (uint16_t)(((uint32_t)level * PWM_PERIOD_TICKS + PWM_LEVEL_MAX / 2) / PWM_LEVEL_MAX);
+  // Takes effect at the start of the next period, except that switching off
+  // is immediate so safety shutdowns do not wait for the period to end.
+  noInterrupts();
+  s_on_ticks[channel] = ticks;
+  if (ticks == 0) {
+    s_carry[channel] = NO_CARRY;
+    for (uint8_t i = s_edge_next; i < s_edge_count; i++) {
+      if (s_edges[i].channel == channel)
+        s_edges[i].on = false;
+    }
+    pin_write(channel, false);
+  }
+  interrupts();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "board_config.h"
+
+// Phase-staggered PWM for the heater ports. Timer1 provides the time base and
+// a compare interrupt switches the pins, so every channel gets the same
+// PWM_LEVEL_MAX + 1 step resolution at PWM_FREQUENCY_HZ regardless of which
+// timer its pin belongs to. Channel i switches on i / PWM_PORT_COUNT of a
+// period after channel 0, spreading the heater current over the period.
+// Timer0 is left alone, so millis() is unaffected.
+
+void pwm_out_attach(uint8_t channel, uint8_t pin);
+void pwm_out_begin();
+void pwm_out_set(uint8_t channel, uint16_t level);
+
+// Conversions to and from the legacy 0..255 scale used by `W` and `S`.
+inline uint16_t pwm_level_from_8bit(uint8_t v) {
+  return (uint16_t)(((uint32_t)v * PWM_LEVEL_MAX + 127) / 255);
+}
+
+inline uint8_t pwm_level_to_8bit(uint16_t level) {
+  if (level == 0)
+    return 0;
+  uint32_t v = ((uint32_t)level * 255 + PWM_LEVEL_MAX / 2) / PWM_LEVEL_MAX;
+  // Keep a running heater visible as non-zero.
+  return v == 0 ? 1 : (uint8_t)v;
+}
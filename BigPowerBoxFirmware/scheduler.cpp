@@ -0,0 +1,86 @@
+#include "scheduler.h"
+
+void scheduler_start(Scheduler* s, unsigned long now) {
+  if (!s)
+    return;
+  for (uint8_t i = 0; i < s->count; i++) {
+    s->tasks[i].period_ms = pgm_read_dword(&s->defs[i].period_ms);
+    s->tasks[i].last_ms = now;
+  }
+  scheduler_clear_stats(s);
+#if TIMING_STATS
+  scheduler_clear_timing(s);
+#endif
+}
+
+bool scheduler_run(Scheduler* s, unsigned long now) {
+  if (!s)
+    return false;
+  uint8_t next = s->count;
+  uint32_t most_overdue = 0;
+  for (uint8_t i = 0; i < s->count; i++) {
+    const TaskState* t = &s->tasks[i];
+    uint32_t elapsed = now - t->last_ms;
+    if (elapsed < t->period_ms)
+      continue;
+    uint32_t overdue = elapsed - t->period_ms;
+    if (next == s->count || overdue > most_overdue) {
+      next = i;
+      most_overdue = overdue;
+    }
+  }
+  if (next == s->count)
+    return false;
+
+  TaskState* t = &s->tasks[next];
+  if (most_overdue >= t->period_ms && t->late < 0xFFFF)
+    t->late++;
+  uint32_t dt_ms = now - t->last_ms;
+  t->last_ms = now;
+  TaskFn run = (TaskFn)pgm_read_ptr(&s->defs[next].run);
+  unsigned long start_us = micros();
+  run(now, dt_ms);
+  uint32_t took_us = micros() - start_us;
+  if (took_us > scheduler_budget_us(s, next) && t->overruns < 0xFFFF)
+    t->overruns++;
+#if TIMING_STATS
+  timing_add(&t->time, took_us);
+#endif
+  return true;
+}
+
+void scheduler_set_period(Scheduler* s, uint8_t task, uint32_t period_ms) {
+  if (!s || task >= s->count)
+    return;
+  s->tasks[task].period_ms = period_ms;
+}
+
+void scheduler_trigger(Scheduler* s, uint8_t task, unsigned long now) {
+  if (!s || task >= s->count)
+    return;
+  s->tasks[task].last_ms = now - s->tasks[task].period_ms;
+}
+
+uint32_t scheduler_budget_us(const Scheduler* s, uint8_t task) {
+  if (!s || task >= s->count)
+    return 0;
+  return pgm_read_dword(&s->defs[task].budget_us);
+}
+
+void scheduler_clear_stats(Scheduler* s) {
+  if (!s)
+    return;
+  for (uint8_t i = 0; i < s->count; i++) {
+    s->tasks[i].overruns = 0;
+    s->tasks[i].late = 0;
+  }
+}
+
+#if TIMING_STATS
+void scheduler_clear_timing(Scheduler* s) {
+  if (!s)
+    return;
+  for (uint8_t i = 0; i < s->count; i++)
+    timing_clear(&s->tasks[i].time);
+}
+#endif
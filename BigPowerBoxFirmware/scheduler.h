@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "timing.h"
+
+typedef void (*TaskFn)(unsigned long now, uint32_t dt_ms);
+
+// Fixed part of a task, kept in PROGMEM.
+struct TaskDef {
+  TaskFn run;
+  uint32_t period_ms;
+  // Run time the task should stay within; longer runs count as overruns.
+  uint32_t budget_us;
+};
+
+struct TaskState {
+  // Starts at TaskDef::period_ms; tasks with a variable rate change it.
+  uint32_t period_ms;
+  unsigned long last_ms;
+  uint16_t overruns;
+  // Runs that started a whole period or more after they were due.
+  uint16_t late;
+#if TIMING_STATS
+  TimingStat time;
+#endif
+};
+
+struct Scheduler {
+  const TaskDef* defs;
+  TaskState* tasks;
+  uint8_t count;
+};
+
+extern Scheduler g_scheduler;
+
+void scheduler_start(Scheduler* s, unsigned long now);
+// Runs the most overdue task, if any; ties go to the earlier table entry.
+// Returns true when a task ran.
+bool scheduler_run(Scheduler* s, unsigned long now);
+void scheduler_set_period(Scheduler* s, uint8_t task, uint32_t period_ms);
+// Makes a task due at once.
+void scheduler_trigger(Scheduler* s, uint8_t task, unsigned long now);
+uint32_t scheduler_budget_us(const Scheduler* s, uint8_t task);
+void scheduler_clear_stats(Scheduler* s);
+#if TIMING_STATS
+void scheduler_clear_timing(Scheduler* s);
+#endif
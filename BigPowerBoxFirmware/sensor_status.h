@@ -0,0 +1,7 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Result of polling a sensor conversion started by a *_trigger call, or a
+// driver init started by a *_init_start call.
+enum SensorStatus : uint8_t { SENSOR_BUSY = 0, SENSOR_DONE, SENSOR_ERROR };
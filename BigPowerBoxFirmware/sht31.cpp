@@ -2,24 +2,81 @@
 
 #include "i2c_bus.h"
 
-bool sht31_init(Sht31* s, uint8_t addr) {
+namespace {
+// A fresh result is available every second in 1 mps mode.
+constexpr unsigned long RETRY_MS = 10;
+constexpr unsigned long TIMEOUT_MS = 1500;
+// The sensor needs 1 ms after Break; two millis() ticks guarantee that.
+constexpr unsigned long BREAK_MS = 2;
+
+bool send_fetch(uint8_t addr) {
+  uint8_t cmd[2] = {0xE0, 0x00};
+  return i2c_write(addr, cmd, 2);
+}
+} // namespace
+
+void sht31_init_start(Sht31* s, uint8_t addr) {
   if (!s)
-    return false;
+    return;
   s->addr = addr;
-  return i2c_probe(addr);
+  s->refetch = false;
+  s->init_step = 0;
+  s->trigger_ms = 0;
+  s->poll_ms = 0;
 }
 
-bool sht31_read(Sht31* s, int16_t* t_centi, uint16_t* rh_centi) {
-  if (!s || !t_centi || !rh_centi)
+SensorStatus sht31_init_poll(Sht31* s) {
+  if (!s)
+    return SENSOR_ERROR;
+  unsigned long now = millis();
+  if (s->init_step == 0) {
+    // A sensor left in periodic mode by an MCU-only reset accepts nothing but
+    // fetch, ART, break and reset, so stop it first. Break NACKs when the
+    // sensor is already idle; that is fine.
+    uint8_t brk[2] = {0x30, 0x93};
+    i2c_write(s->addr, brk, 2);
+    s->init_step = 1;
+    s->poll_ms = now;
+    return SENSOR_BUSY;
+  }
+  if ((now - s->poll_ms) < BREAK_MS)
+    return SENSOR_BUSY;
+  uint8_t cmd[2] = {0x21, 0x30}; // periodic, 1 mps, high repeatability
+  return i2c_write(s->addr, cmd, 2) ? SENSOR_DONE : SENSOR_ERROR;
+}
+
+bool sht31_trigger(Sht31* s) {
+  if (!s)
     return false;
-  uint8_t cmd[2] = {0x24, 0x00}; // single-shot, high repeatability, no stretch
-  if (!i2c_write(s->addr, cmd, 2))
+  if (!send_fetch(s->addr))
     return false;
-  delay(15);
+  s->refetch = false;
+  s->trigger_ms = millis();
+  s->poll_ms = s->trigger_ms;
+  return true;
+}
+
+SensorStatus sht31_collect(Sht31* s, int16_t* t_centi, uint16_t* rh_centi) {
+  if (!s || !t_centi || !rh_centi)
+    return SENSOR_ERROR;
+  unsigned long now = millis();
+  if (s->refetch) {
+    if ((now - s->poll_ms) < RETRY_MS)
+      return SENSOR_BUSY;
+    if (!send_fetch(s->addr))
+      return SENSOR_ERROR;
+    s->refetch = false;
+    return SENSOR_BUSY;
+  }
 
   uint8_t buf[6];
-  if (!i2c_read(s->addr, buf, 6))
-    return false;
+  if (!i2c_read(s->addr, buf, 6)) {
+    if ((now - s->trigger_ms) > TIMEOUT_MS)
+      return SENSOR_ERROR;
+    s->refetch = true;
+    s->poll_ms = now;
+    return SENSOR_BUSY;
+  }
 
   uint16_t raw_t = ((uint16_t)buf[0] << 8) | buf[1];
   uint16_t raw_h = ((uint16_t)buf[3] << 8) | buf[4];
@@ -29,5 +86,5 @@ bool sht31_read(Sht31* s, int16_t* t_centi, uint16_t* rh_centi) {
 
   *t_centi = (int16_t)t;
   *rh_centi = (uint16_t)h;
-  return true;
+  return SENSOR_DONE;
 }
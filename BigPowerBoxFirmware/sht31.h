@@ -2,9 +2,22 @@
 
 #include <Arduino.h>
 
+#include "sensor_status.h"
+
 struct Sht31 {
   uint8_t addr;
+  bool refetch;
+  uint8_t init_step;
+  unsigned long trigger_ms;
+  unsigned long poll_ms;
 };
 
-bool sht31_init(Sht31* s, uint8_t addr);
-bool sht31_read(Sht31* s, int16_t* t_centi, uint16_t* rh_centi);
+// Stops any running acquisition and restarts it in periodic mode
+// (1 measurement/s, high repeatability). sht31_init_poll sends one command
+// per call and reports SENSOR_DONE once the sensor is running.
+void sht31_init_start(Sht31* s, uint8_t addr);
+SensorStatus sht31_init_poll(Sht31* s);
+// Sends the fetch command for the latest periodic result; sht31_collect
+// reads it. A NACKed read means no new result yet and is retried.
+bool sht31_trigger(Sht31* s);
+SensorStatus sht31_collect(Sht31* s, int16_t* t_centi, uint16_t* rh_centi);
@@ -0,0 +1,51 @@
+#include "stack_monitor.h"
+
+#include "board_config.h"
+
+#if defined(__AVR__)
+
+// Linker symbols: start of .data, and the first byte after .bss.
+extern uint8_t __data_start;
+extern uint8_t __heap_start;
+
+// Runs from .init3, after the stack pointer and r1 are set up and before
+// .data and .bss are initialised. Nothing is on the stack yet, so everything
+// from the end of .bss to RAMEND can be painted. Naked and with no locals
+// beyond registers, so it cannot clobber its own frame.
+void stack_paint() __attribute__((naked, used, section(".init3")));
+void stack_paint() {
+  uint8_t* p = &__heap_start;
+  while (p <= (uint8_t*)RAMEND)
+    *p++ = STACK_PAINT_BYTE;
+}
+
+uint16_t stack_static_bytes() {
+  return (uint16_t)(&__heap_start - &__data_start);
+}
+
+uint16_t stack_free_bytes() {
+  return (uint16_t)(SP - (uint16_t)&__heap_start);
+}
+
+uint16_t stack_min_free_bytes() {
+  const uint8_t* p = &__heap_start;
+  while (p <= (const uint8_t*)SP && *p == STACK_PAINT_BYTE)
+    p++;
+  return (uint16_t)(p - &__heap_start);
+}
+
+#else
+
+uint16_t stack_static_bytes() {
+  return 0;
+}
+
+uint16_t stack_free_bytes() {
+  return 0;
+}
+
+uint16_t stack_min_free_bytes() {
+  return 0;
+}
+
+#endif
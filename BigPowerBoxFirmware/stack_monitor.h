@@ -0,0 +1,15 @@
+#pragma once
+
+#include <Arduino.h>
+
+// RAM between the static data and the stack is filled with STACK_PAINT_BYTE
+// before setup() runs; bytes the stack never reached keep that value. The
+// firmware does not allocate from the heap, so that gap is all free RAM.
+// Off AVR the figures read 0.
+
+// Bytes of .data and .bss.
+uint16_t stack_static_bytes();
+// Bytes between the static data and the stack pointer right now.
+uint16_t stack_free_bytes();
+// Bytes the stack has never reached since boot (the high-water mark).
+uint16_t stack_min_free_bytes();
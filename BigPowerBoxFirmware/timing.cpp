@@ -0,0 +1,70 @@
+#include "timing.h"
+
+#if TIMING_STATS
+
+namespace {
+TimingStat s_sections[TIME_SECTION_COUNT];
+uint32_t s_loop_bins[TIMING_LOOP_BINS];
+unsigned long s_last_loop_us = 0;
+bool s_loop_started = false;
+} // namespace
+
+void timing_add(TimingStat* s, uint32_t us) {
+  if (s->count == 0 || us < s->min_us)
+    s->min_us = us;
+  if (us > s->max_us)
+    s->max_us = us;
+  // Halve both sums instead of overflowing; the average stays the same.
+  if (s->total_us + us < s->total_us) {
+    s->total_us >>= 1;
+    s->count >>= 1;
+  }
+  s->total_us += us;
+  s->count++;
+}
+
+void timing_clear(TimingStat* s) {
+  s->count = 0;
+  s->min_us = 0;
+  s->max_us = 0;
+  s->total_us = 0;
+}
+
+void timing_stop(uint8_t section, unsigned long start_us) {
+  if (section < TIME_SECTION_COUNT)
+    timing_add(&s_sections[section], micros() - start_us);
+}
+
+void timing_loop_mark() {
+  unsigned long now = micros();
+  if (s_loop_started) {
+    uint32_t period = (now - s_last_loop_us) / TIMING_LOOP_BIN0_US;
+    uint8_t bin = 0;
+    while (period && bin < TIMING_LOOP_BINS - 1) {
+      period >>= 1;
+      bin++;
+    }
+    s_loop_bins[bin]++;
+  }
+  s_last_loop_us = now;
+  s_loop_started = true;
+}
+
+const TimingStat* timing_section(uint8_t section) {
+  return section < TIME_SECTION_COUNT ? &s_sections[section] : nullptr;
+}
+
+uint32_t timing_loop_bin(uint8_t bin) {
+  return bin < TIMING_LOOP_BINS ? s_loop_bins[bin] : 0;
+}
+
+void timing_reset() {
+  for (uint8_t i = 0; i < TIME_SECTION_COUNT; i++)
+    timing_clear(&s_sections[i]);
+  for (uint8_t i = 0; i < TIMING_LOOP_BINS; i++)
+    s_loop_bins[i] = 0;
+  // The call that asked for the reset would otherwise land in the histogram.
+  s_loop_started = false;
+}
+
+#endif
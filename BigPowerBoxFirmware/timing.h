@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "board_config.h"
+
+// Durations of one code section, in microseconds.
+struct TimingStat {
+  uint32_t count;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint32_t total_us;
+};
+
+enum TimingSection : uint8_t {
+  // One serial command, parsing to reply.
+  TIME_COMMAND = 0,
+  // probes_update calls that had a read in progress.
+  TIME_PROBES,
+  // One config record written to EEPROM.
+  TIME_CONFIG_WRITE,
+  TIME_SECTION_COUNT,
+};
+
+#if TIMING_STATS
+inline unsigned long timing_start() {
+  return micros();
+}
+void timing_stop(uint8_t section, unsigned long start_us);
+// Call at the top of loop().
+void timing_loop_mark();
+void timing_add(TimingStat* s, uint32_t us);
+void timing_clear(TimingStat* s);
+const TimingStat* timing_section(uint8_t section);
+uint32_t timing_loop_bin(uint8_t bin);
+// Clears the sections and the loop histogram.
+void timing_reset();
+#else
+inline unsigned long timing_start() {
+  return 0;
+}
+inline void timing_stop(uint8_t, unsigned long) {}
+inline void timing_loop_mark() {}
+#endif
+
+// Times the rest of the enclosing block.
+struct TimingScope {
+  explicit TimingScope(uint8_t section) : section(section), start_us(timing_start()) {}
+  ~TimingScope() { timing_stop(section, start_us); }
+  uint8_t section;
+  unsigned long start_us;
+};
@@ -0,0 +1,22 @@
+#include "tmp102.h"
+
+#include "i2c_bus.h"
+
+bool tmp102_init(Tmp102* s, uint8_t addr) {
+  if (!s)
+    return false;
+  s->addr = addr;
+  return i2c_probe(addr);
+}
+
+bool tmp102_read(Tmp102* s, int16_t* t_centi) {
+  if (!s || !t_centi)
+    return false;
+  uint8_t buf[2];
+  if (!i2c_read_reg(s->addr, 0x00, buf, 2))
+    return false;
+  // 12-bit two's complement, 0.0625 C per LSB.
+  int16_t raw = (int16_t)(((uint16_t)buf[0] << 8) | buf[1]) >> 4;
+  *t_centi = (int16_t)(((int32_t)raw * 625) / 100);
+  return true;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <Arduino.h>
+
+struct Tmp102 {
+  uint8_t addr;
+};
+
+bool tmp102_init(Tmp102* s, uint8_t addr);
+bool tmp102_read(Tmp102* s, int16_t* t_centi);
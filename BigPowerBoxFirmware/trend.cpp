@@ -0,0 +1,90 @@
+#include "trend.h"
+
+static_assert(TREND_HORIZON_MS % TREND_INTERVAL_MS == 0,
+              "TREND_HORIZON_MS must be a multiple of TREND_INTERVAL_MS");
+static_assert(TREND_MIN_SAMPLES >= 2 && TREND_MIN_SAMPLES <= TREND_DEPTH,
+              "TREND_MIN_SAMPLES must be 2..TREND_DEPTH");
+
+namespace {
+constexpr int32_t HORIZON_STEPS = TREND_HORIZON_MS / TREND_INTERVAL_MS;
+constexpr int32_t STEPS_PER_HOUR = 3600000UL / TREND_INTERVAL_MS;
+// Deviations from the newest sample are clamped so the sums stay well inside
+// int32 for any depth and horizon that fit in RAM.
+constexpr int32_t MAX_DEV_CENTI = 2000;
+
+// Least-squares fit over evenly spaced samples, oldest first. With
+// x_i = 2i - (n - 1) the abscissas are centred on zero, so the slope per
+// sample is 2 * sxy / sxx and the mean is the fitted value at the centre.
+struct Fit {
+  int32_t mean;
+  int32_t sxy;
+  int32_t sxx;
+};
+
+Fit fit(const int16_t* buf, uint8_t head, uint8_t count) {
+  uint8_t n = count;
+  uint8_t oldest = (uint8_t)((head + TREND_DEPTH - n) % TREND_DEPTH);
+  int32_t ref = buf[(head + TREND_DEPTH - 1) % TREND_DEPTH];
+  int32_t sum = 0;
+  int32_t sxy = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    int32_t dev = buf[(oldest + i) % TREND_DEPTH] - ref;
+    if (dev > MAX_DEV_CENTI)
+      dev = MAX_DEV_CENTI;
+    if (dev < -MAX_DEV_CENTI)
+      dev = -MAX_DEV_CENTI;
+    sum += dev;
+    sxy += (2 * (int32_t)i - (n - 1)) * dev;
+  }
+  Fit f;
+  f.mean = ref + sum / n;
+  f.sxy = sxy;
+  f.sxx = (int32_t)n * ((int32_t)n * n - 1) / 3;
+  return f;
+}
+
+// Fitted value HORIZON_STEPS past the newest sample.
+int32_t extrapolate(const Fit& f, uint8_t n) {
+  int32_t num = f.sxy * ((int32_t)n - 1 + 2 * HORIZON_STEPS);
+  return f.mean + (num + (num >= 0 ? f.sxx / 2 : -f.sxx / 2)) / f.sxx;
+}
+} // namespace
+
+void trend_reset(Trend* t) {
+  if (!t)
+    return;
+  t->head = 0;
+  t->count = 0;
+}
+
+void trend_add(Trend* t, int32_t temp_centi, int32_t humid_centi) {
+  if (!t)
+    return;
+  t->temp_centi[t->head] = (int16_t)temp_centi;
+  t->humid_centi[t->head] = (int16_t)humid_centi;
+  t->head = (uint8_t)((t->head + 1) % TREND_DEPTH);
+  if (t->count < TREND_DEPTH)
+    t->count++;
+}
+
+bool trend_project(const Trend* t, int32_t* temp_centi, int32_t* humid_centi) {
+  if (!t || !temp_centi || !humid_centi || t->count < TREND_MIN_SAMPLES)
+    return false;
+  *temp_centi = extrapolate(fit(t->temp_centi, t->head, t->count), t->count);
+  int32_t rh = extrapolate(fit(t->humid_centi, t->head, t->count), t->count);
+  if (rh < 0)
+    rh = 0;
+  if (rh > 10000)
+    rh = 10000;
+  *humid_centi = rh;
+  return true;
+}
+
+bool trend_temp_rate(const Trend* t, int32_t* centi_per_hour) {
+  if (!t || !centi_per_hour || t->count < TREND_MIN_SAMPLES)
+    return false;
+  Fit f = fit(t->temp_centi, t->head, t->count);
+  int32_t num = 2 * f.sxy * STEPS_PER_HOUR;
+  *centi_per_hour = (num + (num >= 0 ? f.sxx / 2 : -f.sxx / 2)) / f.sxx;
+  return true;
+}
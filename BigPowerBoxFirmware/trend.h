@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "board_config.h"
+
+// Recent ambient samples for predictive dew control. A least-squares line
+// through the last TREND_DEPTH samples is extrapolated TREND_HORIZON_MS
+// ahead of the newest one.
+struct Trend {
+  int16_t temp_centi[TREND_DEPTH];
+  int16_t humid_centi[TREND_DEPTH];
+  // Slot of the next sample and number of valid samples.
+  uint8_t head;
+  uint8_t count;
+};
+
+extern Trend g_trend;
+
+void trend_reset(Trend* t);
+void trend_add(Trend* t, int32_t temp_centi, int32_t humid_centi);
+bool trend_project(const Trend* t, int32_t* temp_centi, int32_t* humid_centi);
+bool trend_temp_rate(const Trend* t, int32_t* centi_per_hour);
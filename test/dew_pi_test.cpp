@@ -0,0 +1,142 @@
+// Runs the dew strap PI controller against a first-order thermal model of a
+// heater strap and checks settling, overshoot and integrator wind-up.
+#include <math.h>
+#include <stdio.h>
+
+#include "dew_pi.h"
+
+namespace {
+// Strap model: full power lifts the strap RISE_FULL_C above ambient with time
+// constant TAU_S. The sensor reads the strap in 0.01 C steps.
+constexpr double RISE_FULL_C = 15.0;
+constexpr double TAU_S = 120.0;
+constexpr double AMBIENT_C = 5.0;
+// Control interval: DEW_CONTROL_SAMPLES reads at 1 s.
+constexpr uint32_t DT_MS = 5000;
+constexpr uint16_t DUTY_MAX = PWM_LEVEL_MAX;
+
+struct Plant {
+  double strap_c;
+};
+
+// Advances the plant by dt_ms at a constant duty, in 100 ms steps.
+void plant_step(Plant* p, uint16_t duty, uint32_t dt_ms) {
+  double target = AMBIENT_C + RISE_FULL_C * duty / PWM_LEVEL_MAX;
+  for (uint32_t t = 0; t < dt_ms; t += 100)
+    p->strap_c += (target - p->strap_c) * 0.1 / TAU_S;
+}
+
+int32_t measure(const Plant* p) {
+  return (int32_t)lround(p->strap_c * 100.0);
+}
+
+struct Run {
+  double max_c;
+  double min_c;
+  double settle_s;
+  uint16_t last_duty;
+};
+
+// Runs `seconds` of closed-loop control towards setpoint_c. settle_s is the
+// time after which the strap stayed within band_c of the setpoint.
+Run run(Plant* plant, DewPi* pi, double setpoint_c, uint32_t seconds, double band_c) {
+  Run r = {plant->strap_c, plant->strap_c, 0.0, 0};
+  int32_t setpoint = (int32_t)lround(setpoint_c * 100.0);
+  bool inside = false;
+  for (uint32_t t = 0; t < seconds * 1000; t += DT_MS) {
+    r.last_duty = dew_pi_update(pi, setpoint, measure(plant), DUTY_MAX, DT_MS);
+    plant_step(plant, r.last_duty, DT_MS);
+    if (plant->strap_c > r.max_c)
+      r.max_c = plant->strap_c;
+    if (plant->strap_c < r.min_c)
+      r.min_c = plant->strap_c;
+    bool now_inside = fabs(plant->strap_c - setpoint_c) <= band_c;
+    if (now_inside && !inside)
+      r.settle_s = (t + DT_MS) / 1000.0;
+    inside = now_inside;
+  }
+  if (!inside)
+    r.settle_s = -1.0;
+  return r;
+}
+
+int failures = 0;
+
+void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+bool integrator_in_range(const DewPi* pi) {
+  return pi->integ_q8 >= 0 && pi->integ_q8 <= ((int32_t)DUTY_MAX << 8);
+}
+} // namespace
+
+int main() {
+  // Step from ambient to 5 C above it.
+  Plant plant = {AMBIENT_C};
+  DewPi pi;
+  dew_pi_reset(&pi);
+  Run step = run(&plant, &pi, AMBIENT_C + 5.0, 1800, 0.2);
+  printf("step: settled in %.0f s, overshoot %.2f C\n", step.settle_s, step.max_c - AMBIENT_C - 5.0);
+  expect(step.settle_s >= 0 && step.settle_s <= 900, "step settles within 0.2 C in 15 min");
+  expect(step.max_c - (AMBIENT_C + 5.0) <= 1.0, "step overshoot at most 1 C");
+  expect(fabs(plant.strap_c - (AMBIENT_C + 5.0)) <= 0.05, "no steady-state error");
+  expect(integrator_in_range(&pi), "integrator within the duty range");
+
+  // Unreachable setpoint: the output saturates for 30 minutes. Once the
+  // setpoint is reachable again the integrator must not hold the heater on.
+  plant.strap_c = AMBIENT_C;
+  dew_pi_reset(&pi);
+  Run sat = run(&plant, &pi, AMBIENT_C + 30.0, 1800, 0.2);
+  expect(sat.last_duty == DUTY_MAX, "unreachable setpoint saturates the output");
+  expect(integrator_in_range(&pi), "integrator clamped while saturated high");
+  DewPi probe = pi;
+  expect(dew_pi_update(&probe, (int32_t)lround((AMBIENT_C + 5.0) * 100.0), measure(&plant),
+                       DUTY_MAX, DT_MS) < DUTY_MAX,
+         "output leaves saturation on the first update below the setpoint");
+  // Reference: a fresh controller started from the same strap temperature.
+  Plant fresh_plant = plant;
+  DewPi fresh;
+  dew_pi_reset(&fresh);
+  Run ref = run(&fresh_plant, &fresh, AMBIENT_C + 5.0, 1800, 0.2);
+  Run back = run(&plant, &pi, AMBIENT_C + 5.0, 1800, 0.2);
+  printf("after high saturation: settled in %.0f s, undershoot %.2f C (fresh: %.0f s, %.2f C)\n",
+         back.settle_s, AMBIENT_C + 5.0 - back.min_c, ref.settle_s, AMBIENT_C + 5.0 - ref.min_c);
+  expect(back.settle_s >= 0 && back.settle_s <= ref.settle_s + 30,
+         "recovery from high saturation is no slower than a fresh start");
+  expect(back.min_c >= ref.min_c - 0.1, "no extra undershoot after high saturation");
+
+  // Setpoint below ambient: the heater cannot cool, so the output sits at 0.
+  // The integrator must not wind down and delay the next heat-up.
+  plant.strap_c = AMBIENT_C;
+  dew_pi_reset(&pi);
+  Run cold = run(&plant, &pi, AMBIENT_C - 5.0, 1800, 0.2);
+  expect(cold.last_duty == 0, "setpoint below ambient turns the heater off");
+  expect(integrator_in_range(&pi), "integrator clamped while saturated low");
+  Run warm = run(&plant, &pi, AMBIENT_C + 5.0, 1800, 0.2);
+  printf("after low saturation: settled in %.0f s\n", warm.settle_s);
+  expect(warm.settle_s >= 0 && warm.settle_s <= step.settle_s + 30,
+         "heat-up after low saturation is not delayed");
+
+  // A lower duty limit caps the output and still settles when reachable.
+  plant.strap_c = AMBIENT_C;
+  dew_pi_reset(&pi);
+  int32_t setpoint = (int32_t)lround((AMBIENT_C + 5.0) * 100.0);
+  uint16_t capped_max = 0;
+  for (uint32_t t = 0; t < 1800000; t += DT_MS) {
+    uint16_t duty = dew_pi_update(&pi, setpoint, measure(&plant), DUTY_MAX / 2, DT_MS);
+    if (duty > capped_max)
+      capped_max = duty;
+    plant_step(&plant, duty, DT_MS);
+  }
+  expect(capped_max <= DUTY_MAX / 2, "output respects duty_max");
+  expect(fabs(plant.strap_c - (AMBIENT_C + 5.0)) <= 0.2, "settles under a duty limit");
+
+  if (failures)
+    return 1;
+  printf("dew_pi_test: ok\n");
+  return 0;
+}
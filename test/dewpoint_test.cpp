@@ -0,0 +1,63 @@
+// Compares dewpoint_centi() with the float Magnus formula over the whole
+// clamped input range: -40.96..87.04 C and 1..100 %RH.
+#include <math.h>
+#include <stdio.h>
+
+#include "dewpoint.h"
+
+namespace {
+// Worst-case error documented in dewpoint.h.
+constexpr double MAX_ERROR_C = 0.025;
+
+double magnus_reference(double t, double rh) {
+  const double a = 17.62;
+  const double b = 243.12;
+  double gamma = log(rh / 100.0) + a * t / (b + t);
+  return b * gamma / (a - gamma);
+}
+
+int failures = 0;
+
+void expect(bool ok, const char* what) {
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+} // namespace
+
+int main() {
+  double worst = 0.0;
+  int32_t worst_t = 0;
+  int32_t worst_rh = 0;
+  for (int32_t t = -4096; t <= 8704; t += 4) {
+    for (int32_t rh = 100; rh <= 10000; rh += 10) {
+      double err = fabs(dewpoint_centi(t, rh) / 100.0 - magnus_reference(t / 100.0, rh / 100.0));
+      if (err > worst) {
+        worst = err;
+        worst_t = t;
+        worst_rh = rh;
+      }
+    }
+  }
+  printf("worst error %.4f C at %.2f C, %.2f %%RH\n", worst, worst_t / 100.0, worst_rh / 100.0);
+  expect(worst <= MAX_ERROR_C, "fixed-point dew point within the documented error");
+
+  // Saturated air: the dew point is the temperature.
+  for (int32_t t = -4000; t <= 8000; t += 500)
+    expect(labs(dewpoint_centi(t, 10000) - t) <= 3, "dew point equals temperature at 100 %RH");
+
+  // Inputs outside the table range are clamped.
+  expect(dewpoint_centi(-6000, 5000) == dewpoint_centi(-4096, 5000), "low temperature clamps");
+  expect(dewpoint_centi(12000, 5000) == dewpoint_centi(8704, 5000), "high temperature clamps");
+  expect(dewpoint_centi(2000, 0) == dewpoint_centi(2000, 100), "low humidity clamps");
+  expect(dewpoint_centi(2000, 12000) == dewpoint_centi(2000, 10000), "high humidity clamps");
+
+  expect(dew_margin_centi(2000, 5000) == 2000 - dewpoint_centi(2000, 5000),
+         "margin is temperature minus dew point");
+
+  if (failures)
+    return 1;
+  printf("dewpoint_test: ok\n");
+  return 0;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// Just enough of the Arduino core for the host tests: fixed-width types and
+// program-memory reads. Sources under test must not touch hardware.
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <avr/pgmspace.h>
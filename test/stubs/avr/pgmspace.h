@@ -0,0 +1,11 @@
+#pragma once
+
+// Host stand-in for avr-libc's program-memory access: flash is ordinary
+// memory, so the read macros dereference directly.
+#include <stdint.h>
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_ptr(addr) (*(void* const*)(addr))
@@ -0,0 +1,72 @@
+#!/bin/sh
+# Builds the firmware with arduino-cli, prints the section sizes and the static
+# RAM (.data + .bss) of every object, and fails when flash or static RAM is over
+# FLASH_BUDGET_BYTES / STATIC_RAM_BUDGET_BYTES from board_config.h.
+#
+#   tools/size_check.sh [extra arduino-cli compile options]
+#
+# FQBN selects the board (default arduino:avr:nano), BUILD_PATH the build
+# directory and AVR_SIZE the avr-size binary; by default the one installed
+# with the arduino:avr core is used when avr-size is not on the PATH.
+set -eu
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+SKETCH="$ROOT/BigPowerBoxFirmware"
+FQBN=${FQBN:-arduino:avr:nano}
+BUILD=${BUILD_PATH:-"$ROOT/build"}
+
+if [ -z "${AVR_SIZE:-}" ]; then
+  if command -v avr-size >/dev/null 2>&1; then
+    AVR_SIZE=avr-size
+  else
+    AVR_SIZE=$(ls -d "$HOME"/.arduino15/packages/arduino/tools/avr-gcc/*/bin/avr-size \
+      2>/dev/null | tail -n 1)
+  fi
+fi
+if [ -z "$AVR_SIZE" ]; then
+  echo "size_check: avr-size not found; set AVR_SIZE" >&2
+  exit 2
+fi
+
+budget() {
+  value=$(sed -n "s/^#define $1 \([0-9][0-9]*\).*/\1/p" "$SKETCH/board_config.h")
+  if [ -z "$value" ]; then
+    echo "size_check: $1 missing from board_config.h" >&2
+    exit 2
+  fi
+  echo "$value"
+}
+FLASH_BUDGET=$(budget FLASH_BUDGET_BYTES)
+RAM_BUDGET=$(budget STATIC_RAM_BUDGET_BYTES)
+
+arduino-cli compile --fqbn "$FQBN" --build-path "$BUILD" "$@" "$SKETCH" >/dev/null
+ELF="$BUILD/BigPowerBoxFirmware.ino.elf"
+
+echo "Sections:"
+"$AVR_SIZE" -A "$ELF" | awk '$1 ~ /^\.(text|data|bss|noinit)$/ { printf "  %-8s %6d\n", $1, $2 }'
+
+echo "Static RAM per object (data + bss):"
+find "$BUILD/sketch" "$BUILD/core" "$BUILD/libraries" -name '*.o' 2>/dev/null |
+  while read -r obj; do
+    "$AVR_SIZE" "$obj" | awk -v name="${obj#"$BUILD"/}" 'NR == 2 && $2 + $3 > 0 {
+      printf "  %6d  %s\n", $2 + $3, name
+    }'
+  done | sort -rn
+
+# Berkeley format: text data bss. Flash holds text and the .data initialisers.
+set -- $("$AVR_SIZE" "$ELF" | awk 'NR == 2 { print $1 + $2, $2 + $3 }')
+FLASH=$1
+RAM=$2
+echo "Flash: $FLASH of $FLASH_BUDGET bytes"
+echo "Static RAM: $RAM of $RAM_BUDGET bytes"
+
+status=0
+if [ "$FLASH" -gt "$FLASH_BUDGET" ]; then
+  echo "size_check: flash over budget by $((FLASH - FLASH_BUDGET)) bytes" >&2
+  status=1
+fi
+if [ "$RAM" -gt "$RAM_BUDGET" ]; then
+  echo "size_check: static RAM over budget by $((RAM - RAM_BUDGET)) bytes" >&2
+  status=1
+fi
+exit $status